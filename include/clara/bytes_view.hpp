@@ -0,0 +1,83 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_BYTES_VIEW_HPP
+#define CLARA_BYTES_VIEW_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace clara {
+
+/**
+ * A read-only view of bytes owned by another object, such as a mapped file.
+ *
+ * The view holds a handle to the owner of the bytes, so they stay valid
+ * until the last copy of the view is released. Copies are cheap, they share
+ * the same bytes.
+ *
+ * A view can be the data of a `type::BYTES` engine data, to pass bytes to
+ * the engines of the same process without copying them. When the data is
+ * sent to other processes, the viewed bytes are serialized, and received as
+ * a `std::vector<std::uint8_t>`.
+ */
+class BytesView final
+{
+public:
+    BytesView() = default;
+
+    /**
+     * Creates a view of the given bytes, that are kept alive by the owner.
+     */
+    BytesView(const std::uint8_t* data, std::size_t size, std::shared_ptr<const void> owner)
+      : data_{data}
+      , size_{size}
+      , owner_{std::move(owner)}
+    {
+        // nop
+    }
+
+    /**
+     * Creates a view that owns the given bytes.
+     */
+    explicit BytesView(std::vector<std::uint8_t> bytes)
+    {
+        auto owner = std::make_shared<const std::vector<std::uint8_t>>(std::move(bytes));
+        data_ = owner->data();
+        size_ = owner->size();
+        owner_ = std::move(owner);
+    }
+
+public:
+    auto data() const -> const std::uint8_t* { return data_; }
+
+    auto size() const -> std::size_t { return size_; }
+
+    auto empty() const -> bool { return size_ == 0; }
+
+    auto begin() const -> const std::uint8_t* { return data_; }
+
+    auto end() const -> const std::uint8_t* { return data_ + size_; }
+
+    auto operator[](std::size_t i) const -> std::uint8_t { return data_[i]; }
+
+    /**
+     * Copies the viewed bytes.
+     */
+    auto to_vector() const -> std::vector<std::uint8_t> { return {begin(), end()}; }
+
+private:
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::shared_ptr<const void> owner_;
+};
+
+} // end namespace clara
+
+#endif // end of include guard: CLARA_BYTES_VIEW_HPP
@@ -10,8 +10,10 @@
 #include <clara/engine_data.hpp>
 #include <clara/engine_data_type.hpp>
 
+#include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 /**
@@ -45,11 +47,68 @@ public:
     virtual auto version() const -> std::string = 0;
 
 public:
+    /**
+     * Resets the engine. The service calls it before the engine is
+     * destroyed, so background work can be stopped while the engine
+     * is still complete.
+     */
     virtual void reset() { };
 
     virtual ~Engine() = default;
 };
 
+
+/**
+ * Publishes the results of an engine into the composition of a request,
+ * without waiting for another request.
+ */
+class Emitter
+{
+public:
+    virtual void emit(EngineData& output) = 0;
+
+    virtual ~Emitter() = default;
+};
+
+
+/**
+ * An engine that publishes results on its own.
+ *
+ * Before executing a request that is part of a composition, the service
+ * gives the engine an emitter for that composition, in the same thread that
+ * executes the request. Other requests are executed without setting an
+ * emitter. The engine can keep it and use it from any thread, also after
+ * the request is done.
+ * When the results of a request are emitted, the engine can return an
+ * output without data, and then nothing else is sent for the request.
+ */
+class StreamingEngine
+{
+public:
+    virtual void set_emitter(std::shared_ptr<Emitter> emitter) = 0;
+
+    virtual ~StreamingEngine() = default;
+};
+
+
+/**
+ * An engine with statistics for the runtime report of its service.
+ *
+ * The service publishes the values in its report entry, next to the
+ * request counters. They are read from the report thread, while the engine
+ * is executing requests. With one engine per worker, the values of all the
+ * engines are added.
+ */
+class ReportingEngine
+{
+public:
+    using Stats = std::vector<std::pair<std::string, long>>;
+
+    virtual auto stats() const -> Stats = 0;
+
+    virtual ~ReportingEngine() = default;
+};
+
 } // end namespace clara
 
 #endif // end of include guard: CLARA_ENGINE_HPP
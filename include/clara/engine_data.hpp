@@ -10,9 +10,11 @@
 #include <clara/engine_status.hpp>
 
 #include <any>
+#include <cstdint>
 #include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 namespace clara {
 
@@ -21,6 +23,7 @@ class Meta;
 }
 
 class EngineDataType;
+class Serializer;
 
 class EngineData final
 {
@@ -38,19 +41,24 @@ public:
 public:
     auto mime_type() const -> const std::string&;
 
-    auto data() const -> const std::any&
-    {
-        return data_;
-    }
+    /**
+     * Gets the data.
+     * Received data is deserialized on the first access.
+     */
+    auto data() const -> const std::any&;
 
-    auto data() -> std::any&
-    {
-        return data_;
-    }
+    /**
+     * Gets the data to be modified.
+     * Received data is deserialized on the first access, and the serialized
+     * bytes are discarded, since they may not match the data anymore.
+     */
+    auto data() -> std::any&;
 
     template<typename S, typename T>
     void set_data(S&& type, T&& data)
     {
+        bytes_.reset();
+        serializer_ = nullptr;
         set_mime_type(std::forward<S>(type));
         if constexpr (std::is_constructible_v<std::string, T> &&
                       not std::is_same_v<std::string, std::decay_t<T>>) {
@@ -60,9 +68,9 @@ public:
         }
     }
 
-    auto has_data() -> bool
+    auto has_data() const -> bool
     {
-        return data_.has_value();
+        return data_.has_value() || bytes_;
     }
 
 private:
@@ -105,10 +113,31 @@ private:
     friend class EngineDataAccessor;
     using Meta = msg::proto::Meta;
 
-    EngineData(std::any&& data, std::unique_ptr<Meta>&& meta);
+    using Bytes = std::vector<std::uint8_t>;
+
+    EngineData(std::any&& data, std::unique_ptr<Meta>&& meta, int type_id);
+
+    EngineData(std::shared_ptr<Bytes>&& bytes,
+               const Serializer* serializer,
+               std::unique_ptr<Meta>&& meta,
+               int type_id);
+
+    auto is_pending() const -> bool
+    {
+        return bytes_ && !data_.has_value();
+    }
+
+    void read_bytes() const;
+
+    void recycle_bytes();
 
-    std::any data_;
+    // the data is deserialized on demand (thus mutable);
+    // the bytes are kept while the data is not modified
+    mutable std::any data_;
     std::unique_ptr<Meta> meta_;
+    int type_id_ = -1;
+    std::shared_ptr<Bytes> bytes_;
+    const Serializer* serializer_ = nullptr;
 };
 
 
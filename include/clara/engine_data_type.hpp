@@ -36,6 +36,7 @@ public:
                    std::unique_ptr<Serializer> serializer)
       : mime_type_{mime_type}
       , serializer_{std::move(serializer)}
+      , id_{register_mime_type(mime_type_)}
     {
         // nothing
     }
@@ -48,6 +49,17 @@ public:
         return mime_type_;
     }
 
+    /**
+     * Returns the unique integer ID of the mime-type of this data type.
+     * All data types with the same mime-type share the same ID.
+     * The ID is assigned when the first data type with the mime-type is
+     * created, and it is only valid in the current process.
+     */
+    auto id() const -> int
+    {
+        return id_;
+    }
+
     /**
      * Returns the serializer of this data type.
      */
@@ -56,9 +68,13 @@ public:
         return serializer_.get();
     }
 
+private:
+    static auto register_mime_type(const std::string& mime_type) -> int;
+
 private:
     std::string mime_type_;
     std::shared_ptr<Serializer> serializer_;
+    int id_;
 };
 
 
@@ -129,6 +145,37 @@ extern const EngineDataType BYTES;
  */
 extern const EngineDataType JSON;
 
+/**
+ * An array of 32 bits integers, as a `std::vector<std::int32_t>`.
+ * Serialized as a contiguous little-endian block.
+ */
+extern const EngineDataType ARRAY_INT32;
+
+/**
+ * An array of 64 bits integers, as a `std::vector<std::int64_t>`.
+ * Serialized as a contiguous little-endian block.
+ */
+extern const EngineDataType ARRAY_INT64;
+
+/**
+ * An array of floats, as a `std::vector<float>`.
+ * Serialized as a contiguous little-endian block.
+ */
+extern const EngineDataType ARRAY_FLOAT;
+
+/**
+ * An array of doubles, as a `std::vector<double>`.
+ * Serialized as a contiguous little-endian block.
+ */
+extern const EngineDataType ARRAY_DOUBLE;
+
+/**
+ * A batch of records stored as typed columns, as a {@link RecordBatch}.
+ * Received batches are views of the received bytes, unless they are
+ * shared or misaligned without room to align them, see {@link RecordBatch}.
+ */
+extern const EngineDataType RECORD_BATCH;
+
 } // end namespace mime
 
 } // end namespace clara
@@ -0,0 +1,82 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_MSG_BUFFER_POOL_H_
+#define CLARA_MSG_BUFFER_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace clara::msg {
+
+/**
+ * Recycles the byte buffers used for message payloads.
+ *
+ * Buffers are grouped in power-of-two size classes, from \ref min_size to
+ * \ref max_size. Every thread keeps a released buffer of each class for
+ * itself, and the rest are shared by all threads.
+ * Smaller requests get a buffer of the smallest class, so the payloads of
+ * small events are recycled too. Larger buffers are not pooled.
+ *
+ * Large payloads are allocated and freed with `mmap`/`munmap` by the system
+ * allocator, so reusing them avoids the system calls and the page faults
+ * of touching new memory for every event.
+ */
+class BufferPool
+{
+public:
+    using Buffer = std::vector<std::uint8_t>;
+
+    /// The smallest pooled buffer
+    static constexpr std::size_t min_size = std::size_t{1} << 12;
+
+    /// The largest pooled buffer
+    static constexpr std::size_t max_size = std::size_t{1} << 28;
+
+    /// The maximum total size of the buffers kept by the pool
+    static constexpr std::size_t max_resident_bytes = std::size_t{1} << 30;
+
+    struct Stats
+    {
+        std::uint64_t hits;
+        std::uint64_t misses;
+        std::uint64_t resident_bytes;
+    };
+
+public:
+    /**
+     * Gets an empty buffer with capacity for at least the given size.
+     * A recycled buffer is returned if there is one of the right class.
+     */
+    static auto acquire(std::size_t size) -> Buffer;
+
+    /**
+     * Returns a buffer to the pool, so it can be reused.
+     * The buffer is left empty.
+     * Buffers smaller than \ref min_size or too large, or that would exceed
+     * \ref max_resident_bytes, are freed.
+     */
+    static void release(Buffer&& buffer);
+
+    /**
+     * Asks the system to back new pooled buffers with huge pages.
+     * Only supported on Linux with transparent huge pages enabled
+     * in `madvise` mode. Disabled by default.
+     */
+    static void set_huge_pages(bool enable);
+
+    /**
+     * Gets the number of acquired pooled buffers that were reused (hits)
+     * or allocated (misses), and the total size of the buffers kept by
+     * the pool.
+     */
+    static auto stats() -> Stats;
+};
+
+} // end namespace clara::msg
+
+#endif // CLARA_MSG_BUFFER_POOL_H_
@@ -7,20 +7,31 @@
 #ifndef CLARA_MSG_MESSAGE_HPP_
 #define CLARA_MSG_MESSAGE_HPP_
 
+#include <clara/msg/buffer_pool.hpp>
 #include <clara/msg/proto/data.hpp>
 #include <clara/msg/proto/meta.hpp>
 #include <clara/msg/topic.hpp>
 
 #include <cstdint>
 #include <memory>
+#include <string_view>
 #include <type_traits>
 #include <tuple>
+#include <utility>
 #include <vector>
 
 
 namespace clara::msg {
 
 class Actor;
+class Message;
+
+namespace detail {
+void assign_message(Message& msg,
+                    std::string_view topic,
+                    const void* meta, std::size_t meta_size,
+                    const void* data, std::size_t data_size);
+} // end namespace detail
 
 /**
  * The standard message for Clara pub/sub communications.
@@ -107,6 +118,7 @@ public:
       : topic_{other.topic_}
       , meta_{proto::copy_meta(*other.meta_)}
       , data_{other.data_}
+      , compact_meta_{other.compact_meta_}
     { }
 
     Message(Message&&) = default;
@@ -117,13 +129,17 @@ public:
             topic_ = other.topic_;
             meta_ = proto::copy_meta(*other.meta_);
             data_ = other.data_;
+            compact_meta_ = other.compact_meta_;
         }
         return *this;
     }
 
     auto operator=(Message&&) -> Message& = default;
 
-    ~Message() = default;
+    ~Message()
+    {
+        BufferPool::release(std::move(data_));
+    }
 
 public:
     friend void swap(Message& lhs, Message& rhs)
@@ -132,6 +148,7 @@ public:
         swap(lhs.topic_, rhs.topic_);
         swap(lhs.meta_, rhs.meta_);
         swap(lhs.data_, rhs.data_);
+        swap(lhs.compact_meta_, rhs.compact_meta_);
     }
 
 public:
@@ -144,6 +161,28 @@ public:
     /// Read-only access to the serialized data
     auto data() const -> const std::vector<std::uint8_t>& { return data_; }
 
+public:
+    /// Replaces the topic.
+    /// Useful to publish the same data and metadata to many topics.
+    void set_topic(const Topic& topic) { topic_ = topic; }
+
+    /// Moves the serialized data out of the message.
+    /// The message is left with empty data.
+    auto release_data() -> std::vector<std::uint8_t> { return std::exchange(data_, {}); }
+
+    /// Sends the metadata with the compact format instead of protobuf.
+    /// Only C++ actors that support the format can receive these messages,
+    /// so protobuf is used by default.
+    void set_compact_meta(bool compact) { compact_meta_ = compact; }
+
+    /// Checks if the metadata will be sent with the compact format
+    auto compact_meta() const -> bool { return compact_meta_; }
+
+    /// Moves the metadata out of the message.
+    /// The message is left without metadata, and it cannot be used
+    /// until new values are assigned to it.
+    auto release_meta() -> std::unique_ptr<proto::Meta> { return std::move(meta_); }
+
 public:
     /// Gets the `datatype` identifier from the metadata.
     auto datatype() const -> const std::string& { return meta_->datatype(); }
@@ -159,11 +198,35 @@ public:
     friend auto make_response(Message&& msg) -> Message;
     friend auto make_response(const Message& msg) -> Message;
 
+private:
+    friend void detail::assign_message(Message& msg,
+                                       std::string_view topic,
+                                       const void* meta, std::size_t meta_size,
+                                       const void* data, std::size_t data_size);
+
+    void assign(std::string_view topic,
+                const void* meta, std::size_t meta_size,
+                const void* data, std::size_t data_size)
+    {
+        topic_.topic_.assign(topic);
+        if (!meta_) {
+            meta_ = proto::make_meta();
+        }
+        proto::detail::parse_meta(meta, meta_size, *meta_);
+        if (data_.capacity() < data_size) {
+            BufferPool::release(std::move(data_));
+            data_ = BufferPool::acquire(data_size);
+        }
+        const auto* bytes = static_cast<const std::uint8_t*>(data);
+        data_.assign(bytes, bytes + data_size);
+    }
+
 private:
     friend Actor;
     Topic topic_;
     std::unique_ptr<proto::Meta> meta_;
     std::vector<std::uint8_t> data_;
+    bool compact_meta_ = false;
 };
 
 
@@ -232,6 +295,25 @@ inline auto make_response(const Message& msg) -> Message
 }
 
 
+namespace detail {
+
+/**
+ * Replaces the content of the message with the given serialized parts.
+ *
+ * The buffers already owned by the message are reused, so receiving into the
+ * same message does not allocate once its buffers are large enough.
+ */
+inline void assign_message(Message& msg,
+                           std::string_view topic,
+                           const void* meta, std::size_t meta_size,
+                           const void* data, std::size_t data_size)
+{
+    msg.assign(topic, meta, meta_size, data, data_size);
+}
+
+} // end namespace detail
+
+
 inline auto operator==(const Message& lhs, const Message& rhs) -> bool
 {
     return std::tie(lhs.topic().str(), *lhs.meta(), lhs.data())
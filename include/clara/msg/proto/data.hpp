@@ -24,12 +24,20 @@ using buffer_t = std::vector<std::uint8_t>;
 
 
 template <typename P, typename T>
-inline auto serialize_proto_value(const T& value) -> buffer_t
+inline void serialize_proto_value(const T& value, buffer_t& buffer)
 {
     auto proto = P{};
     proto.set_value(value);
-    auto buffer = buffer_t(proto.ByteSizeLong());
+    buffer.resize(proto.ByteSizeLong());
     proto.SerializeToArray(buffer.data(), static_cast<int>(buffer.size()));
+}
+
+
+template <typename P, typename T>
+inline auto serialize_proto_value(const T& value) -> buffer_t
+{
+    auto buffer = buffer_t{};
+    serialize_proto_value<P>(value, buffer);
     return buffer;
 }
 
@@ -67,6 +75,28 @@ inline auto serialize_value(T&& value) -> buffer_t
 }
 
 
+template <typename T>
+inline void serialize_value(const T& value, buffer_t& buffer)
+{
+    if constexpr(std::is_constructible_v<std::string_view, T>) {
+        auto v = std::string_view{value};
+        buffer.assign(v.begin(), v.end());
+    } else if constexpr(std::is_same_v<T, std::int32_t>) {
+        serialize_proto_value<google::protobuf::Int32Value>(value, buffer);
+    } else if constexpr(std::is_same_v<T, std::int64_t>) {
+        serialize_proto_value<google::protobuf::Int64Value>(value, buffer);
+    } else if constexpr(std::is_same_v<T, float>) {
+        serialize_proto_value<google::protobuf::FloatValue>(value, buffer);
+    } else if constexpr(std::is_same_v<T, double>) {
+        serialize_proto_value<google::protobuf::DoubleValue>(value, buffer);
+    } else if constexpr(std::is_same_v<T, buffer_t>) {
+        buffer.assign(value.begin(), value.end());
+    } else {
+        static_assert(sizeof(T) == 0, "Unsupported type");
+    }
+}
+
+
 template <typename T, typename V,
           typename = std::enable_if_t<std::is_same_v<std::decay_t<V>, buffer_t>>>
 inline auto parse_value(V&& buffer) -> T
@@ -9,8 +9,11 @@
 
 #include "meta.pb.h"
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <stdexcept>
+#include <string>
 
 /**
  * Protobuf data classes and helpers.
@@ -54,6 +57,48 @@ inline void set_datatype(Meta& meta, S&& datatype)
     }
 }
 
+
+/// The first byte of metadata serialized with the compact format.
+/// A serialized protobuf message never starts with a zero byte.
+constexpr std::uint8_t compact_meta_marker = 0x00;
+
+
+/// Checks if the serialized metadata uses the compact format
+inline auto is_compact_meta(const void* data, std::size_t size) -> bool
+{
+    return size > 0 && *static_cast<const std::uint8_t*>(data) == compact_meta_marker;
+}
+
+
+/**
+ * Serializes the metadata with the compact format used between C++ actors.
+ *
+ * The numeric fields are stored at fixed offsets, followed by the
+ * length-prefixed strings, so they can be read without decoding
+ * protobuf tags and varints.
+ * Actors in other languages cannot read this format.
+ */
+void write_compact_meta(const Meta& meta, std::string& buffer);
+
+/**
+ * Reads metadata serialized with the compact format.
+ * The given object is cleared and filled with the values, reusing its memory.
+ *
+ * \throws std::invalid_argument if the data is not valid
+ */
+void read_compact_meta(const void* data, std::size_t size, Meta& meta);
+
+
+/// Reads metadata serialized with the compact or the protobuf format
+inline void parse_meta(const void* data, std::size_t size, Meta& meta)
+{
+    if (is_compact_meta(data, size)) {
+        read_compact_meta(data, size, meta);
+    } else {
+        meta.ParseFromArray(data, static_cast<int>(size));
+    }
+}
+
 } // end namespace detail
 
 
@@ -195,6 +195,7 @@ private:
     { }
 
 private:
+    friend class Message;
     std::string topic_;
 };
 
@@ -0,0 +1,102 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_PROTO_SERIALIZER_HPP
+#define CLARA_PROTO_SERIALIZER_HPP
+
+#include <clara/engine_data_type.hpp>
+#include <clara/serializer.hpp>
+
+#include <google/protobuf/arena.h>
+
+#include <algorithm>
+#include <any>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <string_view>
+#include <vector>
+
+namespace clara {
+
+/**
+ * Serializes protocol buffers messages of type `T`.
+ *
+ * The user object is a `std::shared_ptr<T>`.
+ * Received messages are parsed into an arena owned by the pointer,
+ * so all the nested fields are allocated in a few blocks, and they are
+ * released together when the last copy of the {@link EngineData} is destroyed.
+ * Output messages can be created on the heap with `std::make_shared<T>()`.
+ */
+template<typename T>
+class ProtoSerializer : public Serializer
+{
+public:
+    using Pointer = std::shared_ptr<T>;
+
+public:
+    auto write(const std::any& data) const -> std::vector<std::uint8_t> override
+    {
+        auto buffer = Buffer{};
+        write_into(data, buffer);
+        return buffer;
+    }
+
+    auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
+    {
+        if (buffer.size() > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+            throw std::invalid_argument{"protobuf message is too large"};
+        }
+
+        // most messages need less than twice their serialized size,
+        // so they are parsed into a single block
+        auto options = google::protobuf::ArenaOptions{};
+        options.start_block_size = std::max(min_block_size, 2 * buffer.size());
+
+        auto arena = std::make_shared<google::protobuf::Arena>(options);
+        auto* message = google::protobuf::Arena::CreateMessage<T>(arena.get());
+        if (!message->ParseFromArray(buffer.data(), static_cast<int>(buffer.size()))) {
+            throw std::invalid_argument{"could not parse protobuf message"};
+        }
+
+        // the message shares the ownership of its arena
+        return {Pointer{std::move(arena), message}};
+    }
+
+    void write_into(const std::any& data, Buffer& buffer) const override
+    {
+        const auto& message = std::any_cast<const Pointer&>(data);
+        if (!message) {
+            throw std::invalid_argument{"null protobuf message"};
+        }
+
+        // the computed size is cached by the message, and reused to serialize
+        auto size = message->ByteSizeLong();
+        buffer.resize(size);
+        message->SerializeWithCachedSizesToArray(buffer.data());
+    }
+
+private:
+    static constexpr std::size_t min_block_size = 256;
+};
+
+
+/**
+ * Creates a data type for protocol buffers messages of type `T`,
+ * using a {@link ProtoSerializer}.
+ *
+ * @param mime_type the name of the data type
+ */
+template<typename T>
+auto make_proto_type(std::string_view mime_type) -> EngineDataType
+{
+    return {mime_type, std::make_unique<ProtoSerializer<T>>()};
+}
+
+} // end namespace clara
+
+#endif // end of include guard: CLARA_PROTO_SERIALIZER_HPP
@@ -0,0 +1,292 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_RECORD_BATCH_HPP
+#define CLARA_RECORD_BATCH_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace clara {
+
+/**
+ * The element type of a {@link RecordBatch} column.
+ */
+enum class ColumnType : std::uint8_t
+{
+    INT8 = 1,
+    INT16 = 2,
+    INT32 = 3,
+    INT64 = 4,
+    FLOAT = 5,
+    DOUBLE = 6,
+};
+
+
+namespace detail {
+
+template<typename T>
+constexpr auto column_type() -> ColumnType
+{
+    if constexpr (std::is_same_v<T, std::int8_t>) {
+        return ColumnType::INT8;
+    } else if constexpr (std::is_same_v<T, std::int16_t>) {
+        return ColumnType::INT16;
+    } else if constexpr (std::is_same_v<T, std::int32_t>) {
+        return ColumnType::INT32;
+    } else if constexpr (std::is_same_v<T, std::int64_t>) {
+        return ColumnType::INT64;
+    } else if constexpr (std::is_same_v<T, float>) {
+        return ColumnType::FLOAT;
+    } else if constexpr (std::is_same_v<T, double>) {
+        return ColumnType::DOUBLE;
+    } else {
+        static_assert(sizeof(T) == 0, "Unsupported column type");
+    }
+}
+
+
+/**
+ * Allocates memory aligned to the given number of bytes.
+ */
+template<typename T, std::size_t Alignment>
+struct AlignedAllocator
+{
+    using value_type = T;
+
+    template<typename U>
+    struct rebind
+    {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() = default;
+
+    template<typename U>
+    AlignedAllocator(const AlignedAllocator<U, Alignment>& /*other*/)
+    {
+        // nop
+    }
+
+    auto allocate(std::size_t n) -> T*
+    {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* p, std::size_t /*n*/)
+    {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+
+    template<typename U>
+    auto operator==(const AlignedAllocator<U, Alignment>& /*other*/) const -> bool
+    {
+        return true;
+    }
+
+    template<typename U>
+    auto operator!=(const AlignedAllocator<U, Alignment>& /*other*/) const -> bool
+    {
+        return false;
+    }
+};
+
+} // end namespace detail
+
+
+/**
+ * A read-only view of the values of a {@link RecordBatch} column.
+ * The view is valid while the batch is alive and no columns are added.
+ */
+template<typename T>
+class ColumnView final
+{
+public:
+    using value_type = T;
+    using size_type = std::size_t;
+    using const_iterator = const T*;
+    using iterator = const_iterator;
+
+public:
+    ColumnView(const T* data, std::size_t size)
+      : data_{data}
+      , size_{size}
+    {
+        // nop
+    }
+
+    auto data() const -> const T* { return data_; }
+
+    auto size() const -> std::size_t { return size_; }
+
+    auto begin() const -> const T* { return data_; }
+
+    auto end() const -> const T* { return data_ + size_; }
+
+    auto operator[](std::size_t i) const -> const T& { return data_[i]; }
+
+private:
+    const T* data_;
+    std::size_t size_;
+};
+
+
+/**
+ * A batch of records stored as columns (a structure of arrays).
+ *
+ * Every column has a name, an element type and one value per row.
+ * The values of a column are stored in a contiguous block, and every block
+ * starts at an address multiple of 64 bytes, so columns can be processed
+ * with vectorized kernels.
+ *
+ * The serialized layout is the column blocks preceded by a small header.
+ * All numbers are little-endian:
+ *
+ * - magic `CRB1` (4 bytes)
+ * - number of columns (uint32) and number of rows (uint64)
+ * - for each column: element type (uint8), name length (uint32),
+ *   name bytes, block offset (uint64) and block size in bytes (uint64)
+ * - padding up to a multiple of 64 bytes
+ * - the column blocks, with offsets relative to the end of the header
+ *
+ * The columns of a batch read from a moved buffer are views of that buffer.
+ * When the column blocks of the buffer are not aligned, they are first moved
+ * to the next aligned address inside the same buffer, if its capacity has
+ * room for it. Otherwise, or when the buffer is shared, the blocks are copied
+ * into aligned memory with a single memcpy.
+ */
+class RecordBatch final
+{
+public:
+    static constexpr std::size_t alignment = 64;
+
+    using Buffer = std::vector<std::uint8_t>;
+
+    struct Column
+    {
+        std::string name;
+        ColumnType type;
+        std::size_t offset;
+        std::size_t size;
+    };
+
+public:
+    /**
+     * Creates an empty batch for the given number of rows.
+     */
+    explicit RecordBatch(std::size_t rows = 0)
+      : rows_{rows}
+    {
+        // nop
+    }
+
+    /**
+     * Reads a serialized batch, keeping the buffer as the column storage.
+     *
+     * @throws std::invalid_argument if the buffer is not a valid batch
+     */
+    static auto read(Buffer&& buffer) -> RecordBatch;
+
+    /**
+     * Reads a serialized batch, copying the column blocks.
+     *
+     * @throws std::invalid_argument if the buffer is not a valid batch
+     */
+    static auto read(const Buffer& buffer) -> RecordBatch;
+
+    /**
+     * Serializes the batch into the given buffer.
+     */
+    void write(Buffer& buffer) const;
+
+    /**
+     * Returns the size of the serialized batch.
+     */
+    auto serialized_size() const -> std::size_t;
+
+public:
+    auto rows() const -> std::size_t { return rows_; }
+
+    auto columns() const -> const std::vector<Column>& { return columns_; }
+
+    auto has_column(std::string_view name) const -> bool
+    {
+        return find(name) != nullptr;
+    }
+
+    /**
+     * Adds a new column with the given values.
+     * The number of values must be the number of rows of the batch.
+     *
+     * @throws std::invalid_argument if the name is repeated or the size is wrong
+     */
+    template<typename T>
+    void add_column(std::string_view name, const std::vector<T>& values)
+    {
+        add_column(name, detail::column_type<T>(), values.data(), values.size() * sizeof(T));
+    }
+
+    /**
+     * Gets a read-only view of the values of the given column.
+     *
+     * @throws std::invalid_argument if the column does not exist or
+     *                               the type does not match
+     */
+    template<typename T>
+    auto column(std::string_view name) const -> ColumnView<T>
+    {
+        const auto* col = get(name, detail::column_type<T>());
+        const auto* data = blocks() + col->offset;
+        return {reinterpret_cast<const T*>(data), rows_};  // NOLINT
+    }
+
+private:
+    void add_column(std::string_view name, ColumnType type,
+                    const void* data, std::size_t size);
+
+    auto find(std::string_view name) const -> const Column*;
+
+    auto get(std::string_view name, ColumnType type) const -> const Column*;
+
+    auto header_size() const -> std::size_t;
+
+    // returns the header size, after checking the columns
+    auto read_header(const Buffer& buffer) -> std::size_t;
+
+    auto blocks() const -> const std::uint8_t*
+    {
+        return received_ ? received_->data() + received_offset_ : data_.data();
+    }
+
+    auto blocks_size() const -> std::size_t
+    {
+        return received_ ? received_->size() - received_offset_ : data_.size();
+    }
+
+private:
+    using Storage = std::vector<std::uint8_t, detail::AlignedAllocator<std::uint8_t, alignment>>;
+
+    std::size_t rows_;
+    std::vector<Column> columns_;
+
+    // the blocks of built batches, or copies of the received blocks
+    Storage data_;
+
+    // the received buffer, shared by the copies of the batch
+    std::shared_ptr<const Buffer> received_;
+    std::size_t received_offset_ = 0;
+};
+
+} // end namespace clara
+
+#endif // end of include guard: CLARA_RECORD_BATCH_HPP
@@ -8,6 +8,7 @@
 #define CLARA_DATA_SERIALIZATION_H
 
 #include <any>
+#include <cstddef>
 #include <cstdint>
 #include <vector>
 
@@ -15,6 +16,9 @@ namespace clara {
 
 class Serializer
 {
+public:
+    using Buffer = std::vector<std::uint8_t>;
+
 public:
     /**
      * Serializes the user object into a byte buffer and returns it.
@@ -55,6 +59,33 @@ public:
         return write(data);
     }
 
+public:
+    /**
+     * Returns the expected size of the serialized user object,
+     * or zero if it is not known.
+     * Used to reserve the buffer before calling {@link write_into}.
+     *
+     * @param data the user object stored on the {@link EngineData}
+     */
+    virtual auto size_hint(const std::any& /*data*/) const -> std::size_t
+    {
+        return 0;
+    }
+
+    /**
+     * Serializes the user object into the given byte buffer.
+     * The content of the buffer is replaced, but its memory can be reused.
+     * Override it to avoid allocating a new buffer for every write.
+     *
+     * @param data the user object stored on the {@link EngineData}
+     * @param buffer the buffer where the object will be serialized
+     * @throws ClaraException if the data could not be serialized
+     */
+    virtual void write_into(const std::any& data, Buffer& buffer) const
+    {
+        buffer = write(data);
+    }
+
 public:
     virtual ~Serializer() = default;
 };
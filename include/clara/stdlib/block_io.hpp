@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_STD_BLOCK_IO_HPP
+#define CLARA_STD_BLOCK_IO_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace clara::stdlib {
+
+/**
+ * A problem reading or writing a file with {@link BlockIO}.
+ */
+class BlockIOError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+
+/**
+ * A memory buffer aligned for direct I/O.
+ *
+ * The valid bytes can start after the beginning of the memory, when a read
+ * had to be extended to aligned offsets.
+ */
+class BlockBuffer final
+{
+public:
+    /// The alignment of the memory, and of the offsets and sizes of direct I/O
+    static constexpr std::size_t alignment = 4096;
+
+    BlockBuffer() = default;
+
+    /**
+     * Allocates a buffer that can hold the given number of bytes,
+     * rounded up to the alignment.
+     */
+    explicit BlockBuffer(std::size_t capacity);
+
+    BlockBuffer(BlockBuffer&& other) noexcept;
+    BlockBuffer& operator=(BlockBuffer&& other) noexcept;
+
+public:
+    auto data() -> std::uint8_t* { return memory_.get() + begin_; }
+
+    auto data() const -> const std::uint8_t* { return memory_.get() + begin_; }
+
+    auto size() const -> std::size_t { return size_; }
+
+    auto capacity() const -> std::size_t { return capacity_ - begin_; }
+
+    /**
+     * Sets the number of valid bytes, up to the capacity.
+     */
+    void resize(std::size_t size);
+
+private:
+    friend class BlockIO;
+
+    struct Free
+    {
+        void operator()(std::uint8_t* memory) const { std::free(memory); }
+    };
+
+    std::unique_ptr<std::uint8_t, Free> memory_;
+    std::size_t capacity_ = 0;
+    std::size_t begin_ = 0;
+    std::size_t size_ = 0;
+};
+
+
+/**
+ * A file open for block reads or writes with {@link BlockIO}.
+ */
+class BlockFile final
+{
+public:
+    enum class Mode
+    {
+        Read,
+        Write,
+    };
+
+public:
+    /**
+     * Opens the given file. A file open for writing is created or truncated.
+     *
+     * If direct I/O is requested but the file system does not support it,
+     * the file is open with buffered I/O.
+     *
+     * @throws BlockIOError if the file could not be open
+     */
+    BlockFile(const std::string& path, Mode mode, bool direct = false);
+
+    BlockFile(const BlockFile&) = delete;
+    BlockFile& operator=(const BlockFile&) = delete;
+
+    ~BlockFile();
+
+public:
+    auto fd() const -> int { return fd_; }
+
+    auto path() const -> const std::string& { return path_; }
+
+    /**
+     * Returns true if the file bypasses the page cache.
+     * Then the offsets and sizes of the writes must be aligned.
+     */
+    auto direct() const -> bool { return direct_; }
+
+    /**
+     * Sets the size of the file, to drop the padding of the last
+     * direct write.
+     *
+     * @throws BlockIOError if the size could not be changed
+     */
+    void truncate(std::uint64_t size);
+
+private:
+    std::string path_;
+    int fd_ = -1;
+    bool direct_ = false;
+};
+
+
+/**
+ * Runs block reads and writes on a pool of threads, with positional
+ * system calls, so many of them can be in flight on the same files.
+ */
+class BlockIO final
+{
+public:
+    /**
+     * Starts the given number of I/O threads,
+     * the maximum number of concurrent system calls.
+     */
+    explicit BlockIO(int threads);
+
+    BlockIO(const BlockIO&) = delete;
+    BlockIO& operator=(const BlockIO&) = delete;
+
+    /**
+     * Waits for the requests in flight and stops the threads.
+     */
+    ~BlockIO();
+
+public:
+    /**
+     * Reads the given bytes from a file.
+     * For direct files the read is extended to aligned offsets, and the
+     * returned buffer points to the requested bytes.
+     * The future throws BlockIOError if the bytes could not be read.
+     */
+    auto read(const BlockFile& file, std::uint64_t offset, std::size_t size)
+        -> std::future<BlockBuffer>;
+
+    /**
+     * Writes the bytes of the buffer at the given offset of a file.
+     * For direct files the offset and the size must be aligned.
+     * The future throws BlockIOError if the bytes could not be written.
+     */
+    auto write(const BlockFile& file, std::uint64_t offset, BlockBuffer buffer)
+        -> std::future<void>;
+
+private:
+    void submit(std::function<void()> task);
+    void run();
+
+private:
+    std::vector<std::thread> threads_;
+    std::deque<std::function<void()>> tasks_;
+    bool stop_ = false;
+    std::mutex mutex_;
+    std::condition_variable cv_;
+};
+
+} // end namespace clara::stdlib
+
+#endif // end of include guard: CLARA_STD_BLOCK_IO_HPP
@@ -0,0 +1,255 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_STD_EVENT_FILE_HPP
+#define CLARA_STD_EVENT_FILE_HPP
+
+#include <clara/stdlib/block_io.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <future>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace clara::stdlib {
+
+/**
+ * The byte order of the events stored in an event file.
+ */
+enum class EventFileOrder : std::uint8_t
+{
+    Little = 0,
+    Big = 1,
+};
+
+
+/**
+ * A problem reading or writing an event file.
+ */
+class EventFileError : public std::runtime_error
+{
+public:
+    using std::runtime_error::runtime_error;
+};
+
+
+/**
+ * Writes events into an indexed event file.
+ *
+ * The file is a sequence of length-prefixed records followed by an index
+ * with the offset of every record. All numbers are little-endian:
+ *
+ * - header: magic `CEVF` (4 bytes), version (uint16), byte order of the
+ *   events (uint8) and padding, up to 16 bytes
+ * - for each event: size (uint32) and the event bytes
+ * - index: the offset of every record (uint64)
+ * - footer: number of events (uint64), offset of the index (uint64) and
+ *   magic `CEVI` (4 bytes) with padding, up to 24 bytes
+ *
+ * The index is built while the events are appended, and it is written when
+ * the file is closed. A file that was not closed cannot be read.
+ *
+ * The file can also be written in blocks of {@link block_size} bytes by
+ * {@link BlockIO} threads, with many blocks in flight, optionally bypassing
+ * the page cache.
+ */
+class EventFileWriter final
+{
+public:
+    /**
+     * Creates the given file, replacing it if it exists.
+     *
+     * @throws EventFileError if the file could not be created
+     */
+    explicit EventFileWriter(const std::string& path,
+                             EventFileOrder order = EventFileOrder::Little);
+
+    /**
+     * Creates the given file, replacing it if it exists, to be written with
+     * block writes on the given I/O threads.
+     *
+     * @param depth the maximum number of blocks being written
+     * @param direct if the blocks should be written with direct I/O
+     * @throws EventFileError if the file could not be created
+     */
+    EventFileWriter(const std::string& path,
+                    EventFileOrder order,
+                    BlockIO& io,
+                    int depth,
+                    bool direct = false);
+
+    EventFileWriter(const EventFileWriter&) = delete;
+    EventFileWriter& operator=(const EventFileWriter&) = delete;
+
+    /**
+     * Closes the file if it is still open.
+     * Errors writing the index are ignored, call {@link close()} to get them.
+     */
+    ~EventFileWriter();
+
+public:
+    /**
+     * Appends an event to the file.
+     *
+     * @throws EventFileError if the event could not be written
+     */
+    void write(const std::uint8_t* data, std::size_t size);
+
+    void write(const std::vector<std::uint8_t>& event)
+    {
+        write(event.data(), event.size());
+    }
+
+    /**
+     * Writes the buffered events to the file.
+     * With block writes, the last partial block is kept until it is full.
+     *
+     * @throws EventFileError if the events could not be written
+     */
+    void flush();
+
+    /**
+     * Writes the index and closes the file.
+     *
+     * @throws EventFileError if the index could not be written
+     */
+    void close();
+
+    /**
+     * Returns the number of events written so far.
+     */
+    auto count() const -> std::size_t { return index_.size(); }
+
+    /**
+     * Returns the number of bytes written so far.
+     */
+    auto size() const -> std::uint64_t { return offset_; }
+
+    /**
+     * Returns the path of the file.
+     */
+    auto path() const -> const std::string& { return path_; }
+
+public:
+    /// The size of the block writes
+    static constexpr std::size_t block_size = std::size_t{1} << 20U;
+
+private:
+    void write_header(EventFileOrder order);
+    void put(const void* data, std::size_t size);
+    void put_block(const std::uint8_t* data, std::size_t size);
+    void submit_block();
+    void finish_blocks();
+
+private:
+    std::FILE* file_ = nullptr;
+    std::string path_;
+    std::uint64_t offset_ = 0;
+    std::vector<std::uint64_t> index_;
+
+    // the block writes
+    BlockIO* io_ = nullptr;
+    std::unique_ptr<BlockFile> block_file_;
+    std::size_t depth_ = 0;
+    BlockBuffer block_;
+    std::uint64_t block_offset_ = 0;
+    std::deque<std::future<void>> writes_;
+};
+
+
+/**
+ * Reads events from an indexed event file written by {@link EventFileWriter}.
+ *
+ * The file is mapped into memory, so getting the number of events or any
+ * event is a constant-time lookup in the index, with no system calls.
+ * The reader can be used by many threads at the same time.
+ */
+class EventFileReader final
+{
+public:
+    /**
+     * A view of the bytes of an event.
+     * It is valid while the reader is alive.
+     */
+    struct Event
+    {
+        const std::uint8_t* data;
+        std::size_t size;
+    };
+
+    /**
+     * The location of the bytes of an event in the file.
+     */
+    struct Record
+    {
+        std::uint64_t offset;
+        std::size_t size;
+    };
+
+public:
+    /**
+     * Maps the given file and checks its index.
+     *
+     * @throws EventFileError if the file could not be opened or is not a
+     *         valid event file
+     */
+    explicit EventFileReader(const std::string& path);
+
+    EventFileReader(const EventFileReader&) = delete;
+    EventFileReader& operator=(const EventFileReader&) = delete;
+
+    ~EventFileReader();
+
+public:
+    /**
+     * Returns the number of events in the file.
+     */
+    auto count() const -> std::size_t { return count_; }
+
+    /**
+     * Returns the byte order of the events in the file.
+     */
+    auto order() const -> EventFileOrder { return order_; }
+
+    /**
+     * Gets the event with the given index.
+     *
+     * @throws EventFileError if the index is out of range or the record is
+     *         corrupted
+     */
+    auto event(std::size_t index) const -> Event;
+
+    /**
+     * Gets the location of the event with the given index,
+     * to read it without the mapping.
+     *
+     * @throws EventFileError if the index is out of range or the record is
+     *         corrupted
+     */
+    auto locate(std::size_t index) const -> Record;
+
+    /**
+     * Returns the path of the file.
+     */
+    auto path() const -> const std::string& { return path_; }
+
+private:
+    std::string path_;
+    const std::uint8_t* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::size_t count_ = 0;
+    std::size_t index_offset_ = 0;
+    EventFileOrder order_ = EventFileOrder::Little;
+};
+
+} // end namespace clara::stdlib
+
+#endif // end of include guard: CLARA_STD_EVENT_FILE_HPP
@@ -0,0 +1,101 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_STD_EVENT_FILE_READER_HPP
+#define CLARA_STD_EVENT_FILE_READER_HPP
+
+#include <clara/bytes_view.hpp>
+#include <clara/stdlib/event_file.hpp>
+#include <clara/stdlib/event_reader_service.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace clara::stdlib {
+
+/**
+ * A reader service for the indexed event files written by
+ * {@link EventFileWriterService}.
+ *
+ * Every event is deserialized with the serializer of the given data-type.
+ * The file is mapped into memory, so events are read in constant time in
+ * any order.
+ *
+ * Many files can be read as a single input, with the events numbered across
+ * all of them:
+ *
+ * - if the `files` option is an array of paths, those files are read in
+ *   order, and the `file` option is only used as the name of the input.
+ * - if the `file` option has wildcards, the matching files are read in
+ *   alphabetical order.
+ * - if the `file` option ends in `.manifest`, the files listed in the
+ *   manifest written by {@link EventFileWriterService} are read in order.
+ *
+ * All the files are mapped and their indexes checked when the input is
+ * opened, so there is no pause at the file boundaries while reading.
+ *
+ * If the `zero_copy` option is true and the data-type is `type::BYTES`,
+ * the events are {@link BytesView} slices of the mapped files instead of
+ * copies. A file stays mapped until the last of its events is released,
+ * also after the input is closed. It cannot be combined with `io_depth`.
+ *
+ * With the `io_depth` option, the prefetched events are read with block reads
+ * instead of through the mapping, as described in {@link EventReaderService}.
+ */
+class EventFileReaderService : public EventReaderService
+{
+public:
+    explicit EventFileReaderService(const EngineDataType& data_type = type::BYTES);
+
+    ~EventFileReaderService() override;
+
+public:
+    auto name() const -> std::string override;
+
+    auto author() const -> std::string override;
+
+    auto description() const -> std::string override;
+
+    auto version() const -> std::string override;
+
+private:
+    void open_file(const std::string& file, const json11::Json& opts) override;
+
+    void close_file() override;
+
+    auto has_file() -> bool override;
+
+    auto read_event(int event_number) -> std::any override;
+
+    auto locate_event(int event_number) -> std::optional<EventRecord> override;
+
+    auto decode_event(int event_number,
+                      const std::uint8_t* data,
+                      std::size_t size) -> std::any override;
+
+    auto read_event_count() -> int override;
+
+    auto read_byte_order() -> Endian override;
+
+    auto get_data_type() const -> const EngineDataType& override;
+
+private:
+    auto find_event(int event_number)
+        -> std::pair<std::shared_ptr<EventFileReader>, std::size_t>;
+
+private:
+    EngineDataType data_type_;
+    std::vector<std::shared_ptr<EventFileReader>> readers_;
+    std::vector<std::size_t> first_events_;
+    std::size_t event_count_ = 0;
+    bool zero_copy_ = false;
+};
+
+} // end namespace clara::stdlib
+
+#endif // end of include guard: CLARA_STD_EVENT_FILE_READER_HPP
@@ -0,0 +1,110 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_STD_EVENT_FILE_WRITER_HPP
+#define CLARA_STD_EVENT_FILE_WRITER_HPP
+
+#include <clara/stdlib/event_file.hpp>
+#include <clara/stdlib/event_writer_service.hpp>
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace clara::stdlib {
+
+/**
+ * A writer service that saves the events into an indexed event file,
+ * that can be read by {@link EventFileReaderService}.
+ *
+ * Every event is serialized with the serializer of the given data-type.
+ * The byte order stored in the file is given by the `order` option.
+ *
+ * The events can be spread over many files with these options:
+ *
+ * - `shards`: the number of files written at the same time, each one
+ *   under its own lock (1 by default). The events are assigned to the
+ *   files in round robin.
+ * - `rotate_events`: the number of events after which a file is closed
+ *   and the next one is opened (no limit by default).
+ * - `rotate_mb`: the size in MiB after which a file is closed and the next
+ *   one is opened (no limit by default).
+ *
+ * When any of them is set, the files are named after the configured file,
+ * with a sequence number before the extension (`out_000.cevf`,
+ * `out_001.cevf`, ...), and a manifest with the names of the files and
+ * their number of events is written into `out.cevf.manifest` on close.
+ * If the next file cannot be opened, the failure is reported in the reply
+ * and the events keep going to the current file until the next rotation.
+ *
+ * With the `io_depth` option, every file is written in blocks by the I/O
+ * threads of {@link EventWriterService}, instead of with buffered writes.
+ *
+ * When the events are queued, every batch is written with a single lock
+ * and flush of each file.
+ */
+class EventFileWriterService : public EventWriterService
+{
+public:
+    explicit EventFileWriterService(const EngineDataType& data_type = type::BYTES);
+
+    ~EventFileWriterService() override;
+
+public:
+    auto name() const -> std::string override;
+
+    auto author() const -> std::string override;
+
+    auto description() const -> std::string override;
+
+    auto version() const -> std::string override;
+
+private:
+    void open_file(const std::string& file, const json11::Json& opts) override;
+
+    void close_file() override;
+
+    auto has_file() -> bool override;
+
+    void write_event(const std::any& event) override;
+
+    void write_events(const std::vector<std::any>& events) override;
+
+    auto concurrent_writes() const -> bool override;
+
+    auto get_data_type() const -> const EngineDataType& override;
+
+private:
+    struct Shard;
+
+    void write_buffer(Shard& shard, const Serializer::Buffer& buffer);
+    auto next_file() -> std::unique_ptr<EventFileWriter>;
+    void finish_file(EventFileWriter& writer);
+    void write_manifest();
+
+private:
+    EngineDataType data_type_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::atomic<std::size_t> next_shard_{0};
+
+    // the configured file and the options
+    std::string file_;
+    EventFileOrder order_ = EventFileOrder::Little;
+    bool split_ = false;
+    std::size_t rotate_events_ = 0;
+    std::size_t rotate_bytes_ = 0;
+
+    // the closed files, for the manifest
+    std::mutex files_mutex_;
+    int file_count_ = 0;
+    std::vector<std::pair<std::string, std::size_t>> files_;
+};
+
+} // end namespace clara::stdlib
+
+#endif // end of include guard: CLARA_STD_EVENT_FILE_WRITER_HPP
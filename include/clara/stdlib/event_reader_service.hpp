@@ -10,15 +10,79 @@
 #include <clara/engine.hpp>
 #include <clara/third_party/json11.hpp>
 
+#include <any>
+#include <cstdint>
 #include <memory>
+#include <optional>
 #include <stdexcept>
+#include <string>
+#include <vector>
 
 namespace clara::stdlib {
 
+/**
+ * The events returned for a `next-batch` request to an
+ * {@link EventReaderService}.
+ */
+struct EventBatch
+{
+    /// The index of every event in the file
+    std::vector<long> event_ids;
+
+    /// The events, of the data-type of the reader
+    std::vector<std::any> events;
+};
+
+
+/**
+ * Creates the data-type of the batches of events of the given data-type.
+ * The mime-type of the batches is the mime-type of the events followed
+ * by `;batch`.
+ *
+ * The serialized batch is the number of events (uint32), followed by the
+ * index (int64), size (uint32) and serialized bytes of every event.
+ * All numbers are little-endian.
+ *
+ * @param event_type the data-type of the events
+ */
+auto make_event_batch_type(const EngineDataType& event_type) -> EngineDataType;
+
+
 /**
  * An abstract reader service that reads events from the configured input file.
+ *
+ * If the `prefetch` configuration option is set to N > 0, the events are read
+ * in order by a background thread, up to N events ahead of the requests.
+ * Then {@link #read_event()} is called from that thread, but never
+ * concurrently with the other reader methods.
+ *
+ * If the `io_depth` option is set to N > 0 and the subclass can locate the
+ * bytes of its events with {@link #locate_event()}, the prefetch thread keeps
+ * up to N block reads in flight on a pool of I/O threads, and the events are
+ * created from the read bytes with {@link #decode_event()}.
+ * The files are read with direct I/O if the `direct` option is true.
+ * When `prefetch` is not set, up to N events are prefetched.
+ *
+ * A `next-batch:N` request returns up to N events in a single
+ * {@link EventBatch}, with the communication ID of its first event.
+ * A `next-batch-rec:N` request also marks the events of the batch with the
+ * communication ID of the input as processed.
+ * A batch ends before an event that could not be read, and the error is
+ * returned to the next request.
+ *
+ * If the `stream` configuration option is set to W > 0, the reader publishes
+ * the events into the composition on its own, from a background thread,
+ * with at most W events being processed at the same time.
+ * The first `next` request starts the stream, and every `next-rec` request
+ * marks its event as processed, which allows the next event to be published.
+ * These requests return no data. A request without an emitter, i.e. one that
+ * is not part of a composition, gets the next event in its output.
+ *
+ * The background threads are stopped by `reset()`, which the service calls
+ * before destroying the engine. An instance used outside of a service must
+ * be reset before it is destroyed.
  */
-class EventReaderService : public Engine
+class EventReaderService : public Engine, public StreamingEngine
 {
 public:
     EventReaderService();
@@ -53,6 +117,16 @@ protected:
         {}
     };
 
+    /**
+     * The location of the bytes of an event in a file.
+     */
+    struct EventRecord
+    {
+        std::string file;
+        std::uint64_t offset;
+        std::size_t size;
+    };
+
 private:
     /**
      * Opens the given input file.
@@ -85,6 +159,34 @@ private:
      */
     virtual auto read_event(int event_number) -> std::any = 0;
 
+    /**
+     * Gets where the bytes of an event are stored, to read them with block
+     * I/O. By default the location is not known, and the event is read with
+     * {@link #read_event()}.
+     *
+     * @param event_number the index of the event in the file (starts from zero)
+     * @return the location of the event, if known
+     * @throws EventReaderError if the file could not be read
+     */
+    virtual auto locate_event(int /*event_number*/) -> std::optional<EventRecord>
+    {
+        return std::nullopt;
+    }
+
+    /**
+     * Creates an event from the bytes read from the location returned by
+     * {@link #locate_event()}.
+     *
+     * @param event_number the index of the event in the file (starts from zero)
+     * @param data the bytes of the event
+     * @param size the number of bytes
+     * @return the event
+     * @throws EventReaderError if the bytes are not a valid event
+     */
+    virtual auto decode_event(int event_number,
+                              const std::uint8_t* data,
+                              std::size_t size) -> std::any;
+
     /**
      * Gets the total number of events that can be read from the input file.
      *
@@ -118,6 +220,8 @@ public:
     auto states() const -> std::set<std::string> override;
 
 public:
+    void set_emitter(std::shared_ptr<Emitter> emitter) override;
+
     void reset() override;
 
 private:
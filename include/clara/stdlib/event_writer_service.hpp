@@ -15,11 +15,40 @@
 
 namespace clara::stdlib {
 
+class BlockIO;
+
 /**
  * An abstract writer service that writes all received events into the
  * configured output file.
+ *
+ * If the `queue` configuration option is set to N > 0, the received events
+ * are pushed into a queue of up to N events and the reply is sent right
+ * away. A background thread writes the queued events in batches with
+ * {@link #write_events()}. A failed write is reported in the reply to the
+ * next event. The queue is drained before the file is closed.
+ * The thread is stopped by `reset()`, which the service calls before
+ * destroying the engine. An instance used outside of a service must be
+ * reset before it is destroyed.
+ *
+ * If the `ordered` configuration option is true, the events are written in
+ * the order of their communication IDs, starting from the `skip` option
+ * (zero by default). Events that arrive early are kept in a buffer of up to
+ * `reorder_size` events (1024 by default). When the buffer is full, the
+ * missing events are given up and the buffered events are written.
+ * The events written by a request are reported in its reply: the first
+ * failure is set as the error, with the ID of the event, and the other
+ * failures are logged.
+ *
+ * If the `io_depth` option is set to N > 0, a pool of I/O threads is started
+ * for the open file. Subclasses can get it with {@link #block_writes()}
+ * to keep up to N block writes in flight, with direct I/O if the `direct`
+ * option is true.
+ *
+ * The number of queued events and the reorder statistics are published in
+ * the report of the service, as `queued_events`, `reorder_stalls` and
+ * `reorder_high_water`.
  */
-class EventWriterService : public Engine
+class EventWriterService : public Engine, public ReportingEngine
 {
 public:
     EventWriterService();
@@ -56,6 +85,37 @@ protected:
 
     static auto parse_byte_order(const json11::Json& opts) -> Endian;
 
+    /**
+     * Writes a batch of queued events to the output file.
+     * Only used when the events are written in the background.
+     * The default implementation calls {@link #write_event()} for every
+     * event. Override it to flush the file only once per batch.
+     *
+     * @param events the events to be written, in the received order
+     * @throws EventWriterError if the events could not be written
+     */
+    virtual void write_events(const std::vector<std::any>& events);
+
+    /**
+     * The block I/O configured for the open file.
+     */
+    struct BlockWrites
+    {
+        /// The I/O threads, or null if the `io_depth` option is not set
+        BlockIO* io;
+        /// The maximum number of writes in flight
+        int depth;
+        /// True if the files should be written with direct I/O
+        bool direct;
+    };
+
+    /**
+     * Gets the block I/O configured for the open file.
+     * It can be used from {@link #open_file()} until {@link #close_file()}
+     * returns.
+     */
+    auto block_writes() const -> BlockWrites;
+
 private:
     /**
      * Creates a new writer and opens the given output file.
@@ -87,6 +147,17 @@ private:
      */
     virtual void write_event(const std::any& event) = 0;
 
+    /**
+     * Returns true if {@link #write_event()} and {@link #has_file()} can be
+     * called from many threads at the same time.
+     * Then the received events are not serialized by the service,
+     * except when they are queued or ordered.
+     */
+    virtual auto concurrent_writes() const -> bool
+    {
+        return false;
+    }
+
     /**
      * Gets the Clara engine data-type for the type of the events.
      * The data-type will be used to deserialize the events when the engine data
@@ -103,9 +174,31 @@ public:
 
     auto states() const -> std::set<std::string> override;
 
+public:
+    struct ReorderStats
+    {
+        /// The number of events that arrived before a missing event
+        long stalls;
+        /// The maximum number of events kept in a reorder buffer
+        long high_water;
+    };
+
 public:
     void reset() override;
 
+    /**
+     * Returns the number of events waiting to be written by the background
+     * thread of this service.
+     */
+    auto queued_events() const -> long;
+
+    /**
+     * Returns the reordering statistics of this service.
+     */
+    auto reorder_stats() const -> ReorderStats;
+
+    auto stats() const -> Stats override;
+
 private:
     class Impl;
     std::unique_ptr<Impl> impl_;
@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_TYPED_ENGINE_HPP
+#define CLARA_TYPED_ENGINE_HPP
+
+#include <clara/bytes_view.hpp>
+#include <clara/engine.hpp>
+#include <clara/engine_data.hpp>
+#include <clara/engine_data_type.hpp>
+#include <clara/record_batch.hpp>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace clara {
+
+/**
+ * The Clara data type used to send values of type `T`.
+ *
+ * Specialize it for custom types with a static `get()` function
+ * that returns the data type:
+ *
+ * ```
+ * template<>
+ * struct data_type_of<MyEvent>
+ * {
+ *     static auto get() -> const EngineDataType& { return MY_EVENT; }
+ * };
+ * ```
+ */
+template<typename T>
+struct data_type_of;
+
+#define CLARA_DATA_TYPE_OF(T, DT)                                           \
+    template<>                                                              \
+    struct data_type_of<T>                                                  \
+    {                                                                       \
+        static auto get() -> const EngineDataType& { return DT; }           \
+    };
+
+CLARA_DATA_TYPE_OF(std::int32_t, type::INT32)
+CLARA_DATA_TYPE_OF(std::int64_t, type::INT64)
+CLARA_DATA_TYPE_OF(float, type::FLOAT)
+CLARA_DATA_TYPE_OF(double, type::DOUBLE)
+CLARA_DATA_TYPE_OF(std::string, type::STRING)
+CLARA_DATA_TYPE_OF(std::vector<std::uint8_t>, type::BYTES)
+CLARA_DATA_TYPE_OF(BytesView, type::BYTES)
+CLARA_DATA_TYPE_OF(std::vector<std::int32_t>, type::ARRAY_INT32)
+CLARA_DATA_TYPE_OF(std::vector<std::int64_t>, type::ARRAY_INT64)
+CLARA_DATA_TYPE_OF(std::vector<float>, type::ARRAY_FLOAT)
+CLARA_DATA_TYPE_OF(std::vector<double>, type::ARRAY_DOUBLE)
+CLARA_DATA_TYPE_OF(RecordBatch, type::RECORD_BATCH)
+
+#undef CLARA_DATA_TYPE_OF
+
+
+namespace detail {
+
+// BYTES data can be a vector or a view, converted into the expected type
+template<typename T>
+auto input_value(EngineData& input) -> const T&
+{
+    using Bytes = std::vector<std::uint8_t>;
+    if constexpr (std::is_same_v<T, BytesView>) {
+        if (std::any_cast<Bytes>(&std::as_const(input).data()) != nullptr) {
+            auto& data = input.data();
+            data = BytesView{std::move(*std::any_cast<Bytes>(&data))};
+        }
+    } else if constexpr (std::is_same_v<T, Bytes>) {
+        if (const auto* view = std::any_cast<BytesView>(&std::as_const(input).data())) {
+            input.data() = view->to_vector();
+        }
+    }
+    return data_cast<T>(std::as_const(input));
+}
+
+} // end namespace detail
+
+
+/**
+ * An engine that processes values of type `In` into values of type `Out`.
+ *
+ * The input and output data types are derived from the value types
+ * (see {@link data_type_of}).
+ * The service checks the mime-type of the received data against them before
+ * the engine is called, so the engine does not need to check it again.
+ *
+ * Errors should be reported by throwing an exception, which the service
+ * will send as an error to the orchestrator.
+ */
+template<typename In, typename Out>
+class TypedEngine : public Engine
+{
+public:
+    using input_type = In;
+    using output_type = Out;
+
+public:
+    /**
+     * Processes a single input value.
+     */
+    virtual auto execute(const In& input) -> Out = 0;
+
+public:
+    auto execute(EngineData& input) -> EngineData final
+    {
+        auto output = EngineData{};
+        output.set_data(data_type_of<Out>::get(), execute(detail::input_value<In>(input)));
+        return output;
+    }
+
+    auto execute_group(const std::vector<EngineData>& /*inputs*/) -> EngineData override
+    {
+        return {};
+    }
+
+public:
+    auto input_data_types() const -> std::vector<EngineDataType> override
+    {
+        return {data_type_of<In>::get()};
+    }
+
+    auto output_data_types() const -> std::vector<EngineDataType> override
+    {
+        return {data_type_of<Out>::get()};
+    }
+};
+
+} // end namespace clara
+
+#endif // end of include guard: CLARA_TYPED_ENGINE_HPP
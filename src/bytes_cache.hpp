@@ -0,0 +1,133 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_BYTES_CACHE_HPP
+#define CLARA_BYTES_CACHE_HPP
+
+#include <clara/msg/buffer_pool.hpp>
+
+#include <any>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace clara::util {
+
+/**
+ * Released holders of received bytes of the current thread, ready to be
+ * reused.
+ *
+ * Every received event keeps its bytes in a shared buffer until it is
+ * deserialized, and raw bytes data is stored into a `std::any`. Both need
+ * a small allocation for the holder of the vector. A recycled holder only
+ * gets the new vector moved into it, so it does not allocate once the
+ * thread has processed a few events.
+ * The payloads themselves are returned to the {@link msg::BufferPool}.
+ */
+class BytesCache
+{
+public:
+    using Bytes = std::vector<std::uint8_t>;
+    using SharedBytes = std::shared_ptr<Bytes>;
+
+    static constexpr std::size_t capacity = 16;
+
+public:
+    /**
+     * Gets a shared buffer with the given bytes.
+     */
+    static auto acquire_shared(Bytes&& bytes) -> SharedBytes
+    {
+        auto* cache = local();
+        if (cache == nullptr || cache->shared_.empty()) {
+            return std::make_shared<Bytes>(std::move(bytes));
+        }
+        auto shared = std::move(cache->shared_.back());
+        cache->shared_.pop_back();
+        *shared = std::move(bytes);
+        return shared;
+    }
+
+    /**
+     * Returns a shared buffer to the cache of the current thread,
+     * if nobody else is sharing it. The bytes are returned to the pool.
+     */
+    static void release_shared(SharedBytes&& shared)
+    {
+        if (shared && shared.use_count() == 1) {
+            msg::BufferPool::release(std::move(*shared));
+            shared->clear();
+            auto* cache = local();
+            if (cache != nullptr && cache->shared_.size() < capacity) {
+                cache->shared_.push_back(std::move(shared));
+            }
+        }
+        shared.reset();
+    }
+
+    /**
+     * Gets a `std::any` with the given bytes.
+     */
+    static auto acquire_any(Bytes&& bytes) -> std::any
+    {
+        auto* cache = local();
+        if (cache == nullptr || cache->anys_.empty()) {
+            return {std::move(bytes)};
+        }
+        auto data = std::move(cache->anys_.back());
+        cache->anys_.pop_back();
+        *std::any_cast<Bytes>(&data) = std::move(bytes);
+        return data;
+    }
+
+    /**
+     * Returns a `std::any` with bytes to the cache of the current thread.
+     * The bytes are returned to the pool.
+     */
+    static void release_any(std::any&& data)
+    {
+        if (auto* bytes = std::any_cast<Bytes>(&data)) {
+            msg::BufferPool::release(std::move(*bytes));
+            bytes->clear();
+            auto* cache = local();
+            if (cache != nullptr && cache->anys_.size() < capacity) {
+                cache->anys_.push_back(std::move(data));
+            }
+        }
+        data.reset();
+    }
+
+private:
+    BytesCache()
+    {
+        shared_.reserve(capacity);
+        anys_.reserve(capacity);
+    }
+
+    ~BytesCache()
+    {
+        destroyed = true;
+    }
+
+    // null when the thread is exiting and the cache was already destroyed
+    static auto local() -> BytesCache*
+    {
+        thread_local BytesCache cache;
+        return destroyed ? nullptr : &cache;
+    }
+
+private:
+    static inline thread_local bool destroyed = false;
+
+    std::vector<SharedBytes> shared_;
+    std::vector<std::any> anys_;
+};
+
+} // end namespace clara::util
+
+#endif // end of include guard: CLARA_BYTES_CACHE_HPP
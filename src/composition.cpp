@@ -6,6 +6,9 @@
 
 #include "composition.hpp"
 
+#include "constants.hpp"
+#include "utils.hpp"
+
 #include <sstream>
 #include <stdexcept>
 
@@ -52,4 +55,51 @@ auto SimpleCompiler::outputs() -> std::set<std::string>
     return out;
 }
 
+
+RouteCache::RouteCache(std::string service_name, std::size_t max_size)
+  : service_name_{std::move(service_name)}
+  , max_size_{max_size}
+{
+    // nop
+}
+
+auto RouteCache::get(const std::string& composition)
+    -> std::shared_ptr<const Route>
+{
+    auto route = routes_.find(composition);
+    if (route) {
+        return route;
+    }
+    if (routes_.size() >= max_size_) {
+        routes_.clear();
+    }
+    route = routes_.insert(composition, compile(composition));
+    if (route) {
+        return route;
+    }
+    // another thread compiled the same composition first
+    route = routes_.find(composition);
+    if (route) {
+        return route;
+    }
+    return std::make_shared<const Route>(compile(composition));
+}
+
+auto RouteCache::compile(const std::string& composition) -> Route
+{
+    auto compiler = SimpleCompiler{service_name_};
+    compiler.compile(composition);
+
+    auto route = Route{};
+    for (auto&& name : compiler.outputs()) {
+        auto host = util::get_dpe_host(name);
+        auto port = util::get_dpe_port(name);
+        auto addr = msg::ProxyAddress{std::string{host}, port};
+        auto topic = msg::Topic::raw(name);
+        auto cpp_lang = util::get_dpe_lang(name) == constants::cpp_lang;
+        route.push_back({name, std::move(addr), std::move(topic), cpp_lang});
+    }
+    return route;
+}
+
 } // end namespace clara::composition
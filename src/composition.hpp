@@ -7,9 +7,16 @@
 #ifndef CLARA_COMPOSITION_COMPILER_HPP
 #define CLARA_COMPOSITION_COMPILER_HPP
 
+#include "concurrent_map.hpp"
+
+#include <clara/msg/address.hpp>
+#include <clara/msg/topic.hpp>
+
 #include <list>
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 namespace clara::composition {
 
@@ -28,6 +35,46 @@ private:
     std::list<std::string> next_;
 };
 
+
+/**
+ * An output link of a composition, with the address of its proxy and
+ * the topic of its messages already resolved.
+ */
+struct Link
+{
+    std::string name;
+    msg::ProxyAddress address;
+    msg::Topic topic;
+    bool cpp_lang;
+};
+
+using Route = std::vector<Link>;
+
+
+/**
+ * Thread-safe cache of the compiled routes for all the compositions
+ * received by a service.
+ */
+class RouteCache
+{
+public:
+    static constexpr std::size_t default_max_size = 128;
+
+public:
+    explicit RouteCache(std::string service_name,
+                        std::size_t max_size = default_max_size);
+
+    auto get(const std::string& composition) -> std::shared_ptr<const Route>;
+
+private:
+    auto compile(const std::string& composition) -> Route;
+
+private:
+    std::string service_name_;
+    std::size_t max_size_;
+    util::ConcurrentMap<std::string, Route> routes_;
+};
+
 } // end namespace clara::composition
 
 #endif // end of include guard: CLARA_COMPOSITION_COMPILER_HPP
@@ -74,6 +74,12 @@ public:
         }
     }
 
+    auto size() -> std::size_t
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        return cont_.size();
+    }
+
     void clear()
     {
         std::unique_lock<std::mutex> lock{mutex_};
@@ -9,6 +9,7 @@
 
 #include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <vector>
@@ -51,6 +52,63 @@ private:
 using ThreadPool = tp::ThreadPoolImpl<tp::FixedFunction<void()>, BlockingQueue>;
 
 
+/**
+ * Returns the index of the ThreadPool worker that runs the current thread.
+ * Threads not owned by a pool get an index out of the range of any pool.
+ */
+inline auto current_worker_id() -> std::size_t
+{
+    using Worker = tp::Worker<tp::FixedFunction<void()>, BlockingQueue>;
+    return Worker::getWorkerIdForCurrentThread();
+}
+
+
+/**
+ * A counting semaphore.
+ * A thread that cannot get a permit can wait for one, or take another path.
+ */
+class Semaphore
+{
+public:
+    explicit Semaphore(int permits)
+      : permits_{permits}
+    {
+        // nop
+    }
+
+    void acquire()
+    {
+        std::unique_lock<std::mutex> lock{m_};
+        cv_.wait(lock, [this] { return permits_ > 0; });
+        --permits_;
+    }
+
+    auto try_acquire() -> bool
+    {
+        std::unique_lock<std::mutex> lock{m_};
+        if (permits_ == 0) {
+            return false;
+        }
+        --permits_;
+        return true;
+    }
+
+    void release()
+    {
+        {
+            std::unique_lock<std::mutex> lock{m_};
+            ++permits_;
+        }
+        cv_.notify_one();
+    }
+
+private:
+    std::mutex m_;
+    std::condition_variable cv_;
+    int permits_;
+};
+
+
 template <typename T>
 class ConcurrentRange
 {
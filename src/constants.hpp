@@ -58,6 +58,9 @@ constexpr auto remove_service = "removeService"sv;
 constexpr auto service_report_done = "serviceReportDone"sv;
 constexpr auto service_report_data = "serviceReportData"sv;
 
+constexpr auto engine_shared = "shared"sv;
+constexpr auto engine_per_worker = "per-worker"sv;
+
 constexpr auto set_front_end = "setFrontEnd"sv;
 constexpr auto set_front_end_remote = "setFrontEndRemote"sv;
 
@@ -24,9 +24,11 @@ namespace clara {
 
 Container::Container(const Component& self,
                      const Component& frontend,
-                     std::string_view description)
+                     std::string_view description,
+                     ServiceRegistry* registry)
   : Base{self, frontend}
   , report_{std::make_shared<ContainerReport>(name(), default_author())}
+  , registry_{registry}
   , description_{description}
   , running_{false}
 {
@@ -72,11 +74,14 @@ void Container::add_service(const ServiceParameters& params)
 {
     auto name = params.engine_name;
     auto serv_comp = Component::service(self(), name);
-    auto service = services_.insert(name, serv_comp, frontend(), params);
+    auto service = services_.insert(name, serv_comp, frontend(), params, registry_);
     if (service) {
         try {
             service->start();
             report_->add_service(service->report());
+            if (registry_ != nullptr) {
+                registry_->add(service->name(), service);
+            }
         } catch (const std::exception& e) {
             service->stop();
             services_.remove(name);
@@ -93,6 +98,9 @@ auto Container::remove_service(const std::string& engine_name) -> bool
 {
     auto service = services_.remove(engine_name);
     if (service) {
+        if (registry_ != nullptr) {
+            registry_->remove(service->name());
+        }
         service->stop();
         report_->remove_service(service->report());
         return true;
@@ -103,7 +111,12 @@ auto Container::remove_service(const std::string& engine_name) -> bool
 
 void Container::remove_services()
 {
-    services_.for_each([](auto s) { s->stop(); });
+    services_.for_each([this](auto s) {
+        if (registry_ != nullptr) {
+            registry_->remove(s->name());
+        }
+        s->stop();
+    });
     services_.clear();
 }
 
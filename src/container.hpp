@@ -12,6 +12,7 @@
 #include "concurrent_map.hpp"
 #include "container_report.hpp"
 #include "service.hpp"
+#include "service_registry.hpp"
 
 #include <memory>
 #include <mutex>
@@ -24,7 +25,8 @@ class Container : public Base
 public:
     Container(const Component& self,
               const Component& frontend,
-              std::string_view description);
+              std::string_view description,
+              ServiceRegistry* registry = nullptr);
 
     Container(const Container&) = delete;
 
@@ -52,6 +54,7 @@ private:
 
     util::ConcurrentMap<std::string, Service> services_;
     std::shared_ptr<ContainerReport> report_;
+    ServiceRegistry* registry_;
     std::string description_;
     bool running_;
 };
@@ -26,4 +26,16 @@ auto parse_message(const msg::Message& msg) -> std::string
     return std::string{data.begin(), data.end()};
 }
 
+
+auto parse_engine_mode(std::string_view mode) -> bool
+{
+    if (mode == constants::engine_per_worker) {
+        return true;
+    }
+    if (mode == constants::engine_shared) {
+        return false;
+    }
+    throw InvalidRequest{"invalid engine mode = " + std::string{mode}};
+}
+
 } // end namespace clara::util
@@ -21,6 +21,11 @@ auto build_request(const msg::Topic& topic, std::string_view data) -> msg::Messa
 
 auto parse_message(const msg::Message& msg) -> std::string;
 
+/// Checks the engine mode of a start service request,
+/// and returns true if every worker of the service has its own engine.
+/// Throws InvalidRequest if the mode is unknown.
+auto parse_engine_mode(std::string_view mode) -> bool;
+
 
 class InvalidRequest : public std::logic_error
 {
@@ -15,6 +15,7 @@
 #include "dpe_report.hpp"
 #include "json_report.hpp"
 #include "logging.hpp"
+#include "service_registry.hpp"
 #include "utils.hpp"
 
 #include <clara/msg/actor.hpp>
@@ -92,6 +93,7 @@ private:
 
     std::unique_ptr<msg::sys::Proxy> proxy_;
     std::unique_ptr<msg::Subscription> sub_;
+    ServiceRegistry registry_;
     util::ConcurrentMap<std::string, Container> containers_;
 
     DpeConfig config_;
@@ -244,6 +246,12 @@ void Dpe::DpeImpl::print_startup()
     std::cout << " Date             = " << util::get_current_time() << std::endl;
     std::cout << " Version          = 5.0" << std::endl;
     std::cout << " Lang             = " << "C++" << std::endl;
+    if (config_.fusion) {
+        std::cout << " Fusion           = " << "enabled" << std::endl;
+    }
+    if (config_.compact_meta) {
+        std::cout << " Compact Meta     = " << "enabled" << std::endl;
+    }
     if (!config_.description.empty()) {
         std::cout << " Description      = " << config_.description << std::endl;
     }
@@ -300,7 +308,8 @@ void Dpe::DpeImpl::start_container(util::RequestParser& parser)
     }
 
     auto cont_comp = Component::container(self(), name);
-    auto container = containers_.insert(name, cont_comp, frontend(), "");
+    auto* registry = config_.fusion ? &registry_ : nullptr;
+    auto container = containers_.insert(name, cont_comp, frontend(), "", registry);
     if (container) {
         try {
             container->start();
@@ -327,15 +336,25 @@ void Dpe::DpeImpl::start_service(util::RequestParser& parser)
     auto pool_size = parser.next_integer();
     auto description = parser.next_string();
     auto initial_state = parser.next_string();
+    auto engine_mode = parser.next_string(constants::engine_shared);
     if (pool_size <= 0) {
         pool_size = 1;
     }
 
+    auto service_name = util::make_name(name(), container_name, engine_name);
+    auto engine_per_worker = false;
+    try {
+        engine_per_worker = util::parse_engine_mode(engine_mode);
+    } catch (const util::InvalidRequest& e) {
+        throw util::InvalidRequest{
+                "could not start service = " + service_name + ": " + e.what()};
+    }
+
     ServiceParameters service_params = {
-        engine_name, engine_lib, initial_state, description, pool_size
+        engine_name, engine_lib, initial_state, description, pool_size,
+        engine_per_worker, config_.compact_meta
     };
 
-    auto service_name = util::make_name(name(), container_name, engine_name);
     auto container = containers_.find(container_name);
     if (container) {
         try {
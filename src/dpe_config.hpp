@@ -23,6 +23,8 @@ struct DpeConfig final
     int pool_size = default_pool_size;
     int max_cores = default_max_cores;
     int report_period = default_report_period;
+    bool fusion = false;
+    bool compact_meta = false;
 };
 
 } // end namespace clara
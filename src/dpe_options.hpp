@@ -32,8 +32,11 @@ constexpr auto description = "description";
 constexpr auto poolsize = "poolsize";
 constexpr auto max_cores = "max-cores";
 constexpr auto report = "report";
+constexpr auto fusion = "fusion";
+constexpr auto compact_meta = "compact-meta";
 constexpr auto max_sockets = "max-sockets";
 constexpr auto io_threads = "io-threads";
+constexpr auto huge_pages = "huge-pages";
 
 }
 
@@ -58,11 +61,14 @@ public:
             (opt::poolsize, "size of thread pool to handle requests", value<int>())
             (opt::max_cores, "how many cores can be used by a service", value<int>())
             (opt::report, "the period to publish reports [s]", value<int>())
+            (opt::fusion, "run co-located composition steps in-process")
+            (opt::compact_meta, "send compact metadata to services in C++ DPEs")
             ;
 
         options_.add_options("advanced")
             (opt::max_sockets, "maximum number of allowed ZMQ sockets", value<int>())
             (opt::io_threads, "size of ZMQ thread pool to handle I/O", value<int>())
+            (opt::huge_pages, "use huge pages for large message buffers")
             ;
 
         options_.add_options("other")
@@ -102,12 +108,15 @@ public:
             get(opt::description, ""s),
             get(opt::poolsize, DpeConfig::default_pool_size),
             get(opt::max_cores, DpeConfig::default_max_cores),
-            parse_report_period()
+            parse_report_period(),
+            result_.count(opt::fusion) > 0,
+            result_.count(opt::compact_meta) > 0
         };
 
         // Get ZMQ options
         max_sockets_ = get(opt::max_sockets, 1024);
         io_threads_ = get(opt::io_threads, 1);
+        huge_pages_ = result_.count(opt::huge_pages) > 0;
 
         return true;
     } catch (const cxxopts::OptionException& e) {
@@ -180,6 +189,11 @@ public:
         return io_threads_;
     }
 
+    auto huge_pages() const -> bool
+    {
+        return huge_pages_;
+    }
+
 private:
     cxxopts::Options options_{"c_dpe", "Clara C++ DPE\n"};
     cxxopts::ParseResult result_;
@@ -191,6 +205,7 @@ private:
 
     int max_sockets_;
     int io_threads_;
+    bool huge_pages_ = false;
 };
 
 } // end namespace clara
@@ -10,6 +10,8 @@
 #include "json_utils.hpp"
 #include "utils.hpp"
 
+#include <clara/msg/buffer_pool.hpp>
+
 #include <cstdlib>
 #include <stdexcept>
 
@@ -90,6 +92,23 @@ auto DpeReport::load() const -> double
 }
 
 
+auto DpeReport::buffer_pool_hit_rate() const -> double
+{
+    auto stats = msg::BufferPool::stats();
+    auto requests = stats.hits + stats.misses;
+    if (requests == 0) {
+        return 0.0;
+    }
+    return static_cast<double>(stats.hits) / static_cast<double>(requests);
+}
+
+
+auto DpeReport::buffer_pool_resident_bytes() const -> long
+{
+    return static_cast<long>(msg::BufferPool::stats().resident_bytes);
+}
+
+
 void DpeReport::add_container(const element_type& container)
 {
     containers_.add(container);
@@ -54,6 +54,10 @@ public:
 
     auto load() const -> double;
 
+    auto buffer_pool_hit_rate() const -> double;
+
+    auto buffer_pool_resident_bytes() const -> long;
+
 public:
     void add_container(const element_type& container);
 
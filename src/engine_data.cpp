@@ -6,8 +6,12 @@
 
 #include <clara/engine_data.hpp>
 #include <clara/engine_data_type.hpp>
+#include <clara/serializer.hpp>
 
-#include <clara/msg/proto/meta.hpp>
+#include <clara/msg/buffer_pool.hpp>
+
+#include "bytes_cache.hpp"
+#include "meta_cache.hpp"
 
 #include <stdexcept>
 
@@ -16,15 +20,30 @@ namespace clara {
 
 EngineData::EngineData()
   : data_{}  // NOLINT
-  , meta_{std::make_unique<Meta>()}
+  , meta_{util::MetaCache::acquire()}
 {
     // nop
 }
 
 
-EngineData::EngineData(std::any&& data, std::unique_ptr<Meta>&& meta)
+EngineData::EngineData(std::any&& data, std::unique_ptr<Meta>&& meta, int type_id)
   : data_{std::move(data)}
   , meta_{std::move(meta)}
+  , type_id_{type_id}
+{
+    // nop
+}
+
+
+EngineData::EngineData(std::shared_ptr<Bytes>&& bytes,
+                       const Serializer* serializer,
+                       std::unique_ptr<Meta>&& meta,
+                       int type_id)
+  : data_{}  // NOLINT
+  , meta_{std::move(meta)}
+  , type_id_{type_id}
+  , bytes_{std::move(bytes)}
+  , serializer_{serializer}
 {
     // nop
 }
@@ -32,7 +51,10 @@ EngineData::EngineData(std::any&& data, std::unique_ptr<Meta>&& meta)
 
 EngineData::EngineData(const EngineData& rhs)
   : data_{rhs.data_}
-  , meta_{msg::proto::copy_meta(*rhs.meta_)}
+  , meta_{util::MetaCache::acquire(*rhs.meta_)}
+  , type_id_{rhs.type_id_}
+  , bytes_{rhs.bytes_}
+  , serializer_{rhs.serializer_}
 {
     // nop
 }
@@ -44,14 +66,75 @@ auto EngineData::operator=(const EngineData& rhs) -> EngineData&
 {
     if (this != &rhs) {
         data_ = rhs.data_;
-        meta_ = msg::proto::copy_meta(*rhs.meta_);
+        if (meta_) {
+            meta_->CopyFrom(*rhs.meta_);
+        } else {
+            meta_ = util::MetaCache::acquire(*rhs.meta_);
+        }
+        type_id_ = rhs.type_id_;
+        bytes_ = rhs.bytes_;
+        serializer_ = rhs.serializer_;
     }
     return *this;
 }
 
 auto EngineData::operator=(EngineData&&) noexcept -> EngineData& = default;
 
-EngineData::~EngineData() = default;
+EngineData::~EngineData()
+{
+    util::MetaCache::release(std::move(meta_));
+    recycle_bytes();
+
+    // raw bytes data is usually a received buffer too
+    util::BytesCache::release_any(std::move(data_));
+}
+
+
+auto EngineData::data() const -> const std::any&
+{
+    if (is_pending()) {
+        read_bytes();
+    }
+    return data_;
+}
+
+
+auto EngineData::data() -> std::any&
+{
+    if (is_pending()) {
+        if (bytes_.use_count() == 1) {
+            // nobody else is sharing the bytes, the serializer can reuse them
+            try {
+                data_ = serializer_->read(std::move(*bytes_));
+            } catch (const std::exception& e) {
+                throw std::runtime_error{"could not deserialize " + mime_type() + ": " + e.what()};
+            }
+        } else {
+            read_bytes();
+        }
+    }
+    recycle_bytes();
+    serializer_ = nullptr;
+    return data_;
+}
+
+
+void EngineData::recycle_bytes()
+{
+    // the received buffer can be reused for new messages
+    // if nobody else is sharing it
+    util::BytesCache::release_shared(std::move(bytes_));
+}
+
+
+void EngineData::read_bytes() const
+{
+    try {
+        data_ = serializer_->read(*bytes_);
+    } catch (const std::exception& e) {
+        throw std::runtime_error{"could not deserialize " + mime_type() + ": " + e.what()};
+    }
+}
 
 
 auto EngineData::mime_type() const -> const std::string&
@@ -63,18 +146,21 @@ auto EngineData::mime_type() const -> const std::string&
 void EngineData::set_mime_type(const std::string& mime_type)
 {
     meta_->set_datatype(mime_type);
+    type_id_ = -1;
 }
 
 
 void EngineData::set_mime_type(std::string&& mime_type)
 {
     meta_->set_datatype(std::move(mime_type));
+    type_id_ = -1;
 }
 
 
 void EngineData::set_mime_type(const EngineDataType& data_type)
 {
     meta_->set_datatype(data_type.mime_type());
+    type_id_ = data_type.id();
 }
 
 
@@ -11,20 +11,103 @@
 #include <clara/engine_data_type.hpp>
 #include <clara/engine_status.hpp>
 
+#include <clara/msg/buffer_pool.hpp>
 #include <clara/msg/message.hpp>
 
+#include "bytes_cache.hpp"
+#include "meta_cache.hpp"
+
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 namespace clara {
 
+/**
+ * The data types supported by a service, indexed by their mime-type ID.
+ * Built once when the service is created, and read-only after that.
+ */
+class DataTypeTable final
+{
+public:
+    explicit DataTypeTable(std::vector<EngineDataType> data_types)
+      : types_{std::move(data_types)}
+    {
+        // the first data type of a mime-type is used, like a linear search
+        for (const auto& dt : types_) {
+            auto id = static_cast<std::size_t>(dt.id());
+            if (id >= index_.size()) {
+                index_.resize(id + 1, nullptr);
+            }
+            if (index_[id] == nullptr) {
+                index_[id] = &dt;
+            }
+            names_.emplace(dt.mime_type(), &dt);
+        }
+    }
+
+    DataTypeTable(const DataTypeTable&) = delete;
+    auto operator=(const DataTypeTable&) -> DataTypeTable& = delete;
+
+    ~DataTypeTable() = default;
+
+public:
+    auto find(int id) const -> const EngineDataType*
+    {
+        auto idx = static_cast<std::size_t>(id);
+        return idx < index_.size() ? index_[idx] : nullptr;
+    }
+
+    auto find(const std::string& mime_type) const -> const EngineDataType*
+    {
+        auto it = names_.find(mime_type);
+        return it != names_.end() ? it->second : nullptr;
+    }
+
+    auto data_types() const -> const std::vector<EngineDataType>&
+    {
+        return types_;
+    }
+
+private:
+    std::vector<EngineDataType> types_;
+    std::vector<const EngineDataType*> index_;
+    std::unordered_map<std::string, const EngineDataType*> names_;
+};
+
+
 class EngineDataAccessor final
 {
 public:
-    auto create(std::any&& data, std::unique_ptr<msg::proto::Meta>&& meta)
-        -> EngineData
+    auto create(std::any&& data,
+                std::unique_ptr<msg::proto::Meta>&& meta,
+                int type_id = -1) -> EngineData
     {
-        return EngineData{std::move(data), std::move(meta)};
+        return EngineData{std::move(data), std::move(meta), type_id};
+    }
+
+    auto find_type(const EngineData& data,
+                   const DataTypeTable& data_types) const -> const EngineDataType*
+    {
+        // data types with the same mime-type have the same ID,
+        // so if the ID is known there is no need to check the string
+        if (data.type_id_ >= 0) {
+            return data_types.find(data.type_id_);
+        }
+        return data_types.find(data.meta_->datatype());
+    }
+
+    /// Checks if the data still has the serialized bytes it was received with
+    auto has_bytes(const EngineData& data) const -> bool
+    {
+        return bool(data.bytes_);
+    }
+
+    /// Checks if the received data has been deserialized
+    auto is_deserialized(const EngineData& data) const -> bool
+    {
+        return data.data_.has_value();
     }
 
     auto view_meta(const EngineData& data) -> const msg::proto::Meta*
@@ -43,51 +126,96 @@ public:
         return data.meta_;
     }
 
+    /// The given buffer is reused to serialize the data, if possible
     auto serialize(const EngineData& data,
                    const msg::Topic& topic,
-                   const std::vector<EngineDataType>& data_types) -> msg::Message
+                   const DataTypeTable& data_types,
+                   EngineData::Bytes&& buffer = {}) -> msg::Message
     {
         using Msg = msg::Message;
 
         const auto& mime_type = data.meta_->datatype();
-        for (auto&& dt : data_types) {
-            if (dt.mime_type() == mime_type) {
-                try {
-                    auto bb = dt.serializer()->write(data.data_);
-                    auto mm = msg::proto::copy_meta(*data.meta_);
-                    return Msg{topic, std::move(mm), std::move(bb)};
-                } catch (const std::exception& e) {
-                    throw std::runtime_error{"could not serialize " + mime_type + ": " + e.what()};
+        const auto* dt = find_type(data, data_types);
+        if (dt != nullptr) {
+            try {
+                auto bb = write(data, dt->serializer(), std::move(buffer));
+                auto mm = util::MetaCache::acquire(*data.meta_);
+                if (is_raw_array(*dt)) {
+                    mm->set_byteorder(msg::proto::Meta::Little);
                 }
+                return Msg{topic, std::move(mm), std::move(bb)};
+            } catch (const std::exception& e) {
+                throw std::runtime_error{"could not serialize " + mime_type + ": " + e.what()};
             }
         }
-        if (mime_type == type::STRING.mime_type()) {
-            auto bb = type::STRING.serializer()->write(data.data_);
-            auto mm = msg::proto::copy_meta(*data.meta_);
+        if (is_string(data)) {
+            auto bb = write(data, type::STRING.serializer(), std::move(buffer));
+            auto mm = util::MetaCache::acquire(*data.meta_);
             return Msg{topic, std::move(mm), std::move(bb)};
         }
         throw std::runtime_error{"unsupported output mime-type = " + mime_type};
     }
 
 
-    auto deserialize(const msg::Message& msg,
-                     const std::vector<EngineDataType>& data_types) -> EngineData
+    /// The data is moved out of the message, and deserialized on first access
+    auto deserialize(msg::Message& msg,
+                     const DataTypeTable& data_types) -> EngineData
     {
         const auto* metadata = msg.meta();
         const auto& mime_type = metadata->datatype();
-        for (auto&& dt : data_types) {
-            if (dt.mime_type() == mime_type) {
-                try {
-                    auto user_data = dt.serializer()->read(msg.data());
-                    auto user_meta = msg::proto::copy_meta(*metadata);
-                    return create(std::move(user_data), std::move(user_meta));
-                } catch (const std::exception& e) {
-                    throw std::runtime_error{"could not deserialize " + mime_type + ": " + e.what()};
-                }
+        const auto* dt = data_types.find(mime_type);
+        if (dt != nullptr) {
+            if (is_raw_array(*dt) && metadata->byteorder() != msg::proto::Meta::Little) {
+                throw std::runtime_error{"unsupported byte order for mime-type = " + mime_type};
             }
+            auto bytes = util::BytesCache::acquire_shared(msg.release_data());
+            auto user_meta = util::MetaCache::acquire(*metadata);
+            return EngineData{std::move(bytes), dt->serializer(),
+                              std::move(user_meta), dt->id()};
         }
         throw std::runtime_error{"unsupported input mime-type = " + mime_type};
     }
+
+private:
+    // untouched received data is not serialized again
+    static auto write(const EngineData& data,
+                      const Serializer* serializer,
+                      EngineData::Bytes&& buffer) -> EngineData::Bytes
+    {
+        if (data.bytes_) {
+            reserve(buffer, data.bytes_->size());
+            buffer.assign(data.bytes_->begin(), data.bytes_->end());
+            return std::move(buffer);
+        }
+        reserve(buffer, serializer->size_hint(data.data_));
+        serializer->write_into(data.data_, buffer);
+        return std::move(buffer);
+    }
+
+    static void reserve(EngineData::Bytes& buffer, std::size_t size)
+    {
+        if (size > buffer.capacity()) {
+            msg::BufferPool::release(std::move(buffer));
+            buffer = msg::BufferPool::acquire(size);
+        }
+    }
+
+    // raw arrays are always serialized in little-endian order,
+    // and other orders are rejected on receive
+    static auto is_raw_array(const EngineDataType& data_type) -> bool
+    {
+        auto id = data_type.id();
+        return id == type::ARRAY_INT32.id() || id == type::ARRAY_INT64.id() ||
+               id == type::ARRAY_FLOAT.id() || id == type::ARRAY_DOUBLE.id();
+    }
+
+    static auto is_string(const EngineData& data) -> bool
+    {
+        if (data.type_id_ >= 0) {
+            return data.type_id_ == type::STRING.id();
+        }
+        return data.meta_->datatype() == type::STRING.mime_type();
+    }
 };
 
 } // end namespace clara
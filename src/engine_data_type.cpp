@@ -5,11 +5,21 @@
  */
 
 #include <clara/engine_data_type.hpp>
+#include <clara/bytes_view.hpp>
+#include <clara/record_batch.hpp>
 
 #include <clara/msg/mimetype.hpp>
 #include <clara/msg/proto/data.hpp>
 
+#include "bytes_cache.hpp"
+
+#include <algorithm>
+#include <cstring>
 #include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <type_traits>
+#include <unordered_map>
 
 namespace {
 
@@ -23,6 +33,23 @@ public:
         return clara::msg::proto::detail::serialize_value(value);
     }
 
+    void write_into(const std::any& data, Buffer& buffer) const override
+    {
+        const T& value = std::any_cast<const T&>(data);
+        clara::msg::proto::detail::serialize_value(value, buffer);
+    }
+
+    // the largest wrapper message: a tag byte and the value,
+    // a fixed float or a varint of up to ten bytes
+    auto size_hint(const std::any& /*data*/) const -> std::size_t override
+    {
+        if constexpr (std::is_floating_point_v<T>) {
+            return 1 + sizeof(T);
+        } else {
+            return 11;
+        }
+    }
+
     auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
     {
         return clara::msg::proto::detail::parse_value<T>(buffer);
@@ -30,19 +57,44 @@ public:
 };
 
 
+// the data can also be a view of bytes owned by someone else
 class RawBytesSerializer : public clara::Serializer
 {
 public:
     auto write(const std::any& data) const -> std::vector<std::uint8_t> override
     {
+        if (const auto* view = std::any_cast<clara::BytesView>(&data)) {
+            return view->to_vector();
+        }
         return std::any_cast<std::vector<std::uint8_t>>(data);
     }
 
     auto write(std::any&& data) const -> std::vector<std::uint8_t> override
     {
+        if (const auto* view = std::any_cast<clara::BytesView>(&data)) {
+            return view->to_vector();
+        }
         return std::any_cast<std::vector<std::uint8_t>>(std::move(data));
     }
 
+    auto size_hint(const std::any& data) const -> std::size_t override
+    {
+        if (const auto* view = std::any_cast<clara::BytesView>(&data)) {
+            return view->size();
+        }
+        return std::any_cast<const std::vector<std::uint8_t>&>(data).size();
+    }
+
+    void write_into(const std::any& data, Buffer& buffer) const override
+    {
+        if (const auto* view = std::any_cast<clara::BytesView>(&data)) {
+            buffer.assign(view->begin(), view->end());
+            return;
+        }
+        const auto& value = std::any_cast<const std::vector<std::uint8_t>&>(data);
+        buffer.assign(std::begin(value), std::end(value));
+    }
+
     auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
     {
         return {buffer};
@@ -50,7 +102,7 @@ public:
 
     auto read(std::vector<std::uint8_t>&& buffer) const -> std::any override
     {
-        return {std::move(buffer)};
+        return clara::util::BytesCache::acquire_any(std::move(buffer));
     }
 };
 
@@ -64,12 +116,113 @@ public:
         return {std::begin(value), std::end(value)};
     }
 
+    auto size_hint(const std::any& data) const -> std::size_t override
+    {
+        return std::any_cast<const std::string&>(data).size();
+    }
+
+    void write_into(const std::any& data, Buffer& buffer) const override
+    {
+        const auto& value = std::any_cast<const std::string&>(data);
+        buffer.assign(std::begin(value), std::end(value));
+    }
+
     auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
     {
         return {std::string{std::begin(buffer), std::end(buffer)}};
     }
 };
 
+template<typename T>
+class RawArraySerializer : public clara::Serializer
+{
+public:
+    using Array = std::vector<T>;
+
+    auto write(const std::any& data) const -> std::vector<std::uint8_t> override
+    {
+        auto buffer = std::vector<std::uint8_t>{};
+        write_into(data, buffer);
+        return buffer;
+    }
+
+    auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
+    {
+        if (buffer.size() % sizeof(T) != 0) {
+            throw std::invalid_argument{"invalid raw array size"};
+        }
+        auto value = Array(buffer.size() / sizeof(T));
+        std::memcpy(value.data(), buffer.data(), buffer.size());
+        if constexpr (big_endian) {
+            for (auto& v : value) {
+                swap_bytes(v);
+            }
+        }
+        return {std::move(value)};
+    }
+
+    auto size_hint(const std::any& data) const -> std::size_t override
+    {
+        return std::any_cast<const Array&>(data).size() * sizeof(T);
+    }
+
+    void write_into(const std::any& data, Buffer& buffer) const override
+    {
+        const auto& value = std::any_cast<const Array&>(data);
+        buffer.resize(value.size() * sizeof(T));
+        std::memcpy(buffer.data(), value.data(), buffer.size());
+        if constexpr (big_endian) {
+            for (auto* it = buffer.data(); it != buffer.data() + buffer.size(); it += sizeof(T)) {
+                std::reverse(it, it + sizeof(T));
+            }
+        }
+    }
+
+private:
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    static constexpr bool big_endian = true;
+#else
+    static constexpr bool big_endian = false;
+#endif
+
+    static void swap_bytes(T& value)
+    {
+        auto* bytes = reinterpret_cast<std::uint8_t*>(&value);  // NOLINT
+        std::reverse(bytes, bytes + sizeof(T));
+    }
+};
+
+class RecordBatchSerializer : public clara::Serializer
+{
+public:
+    auto write(const std::any& data) const -> std::vector<std::uint8_t> override
+    {
+        auto buffer = std::vector<std::uint8_t>{};
+        write_into(data, buffer);
+        return buffer;
+    }
+
+    auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
+    {
+        return {clara::RecordBatch::read(buffer)};
+    }
+
+    auto read(std::vector<std::uint8_t>&& buffer) const -> std::any override
+    {
+        return {clara::RecordBatch::read(std::move(buffer))};
+    }
+
+    auto size_hint(const std::any& data) const -> std::size_t override
+    {
+        return std::any_cast<const clara::RecordBatch&>(data).serialized_size();
+    }
+
+    void write_into(const std::any& data, Buffer& buffer) const override
+    {
+        std::any_cast<const clara::RecordBatch&>(data).write(buffer);
+    }
+};
+
 // ---------------------------------------------------------------------------
 
 template<typename T>
@@ -78,10 +231,33 @@ auto s_primitive() -> std::unique_ptr<clara::Serializer>
     return std::make_unique<PrimitiveSerializer<T>>();
 }
 
+template<typename T>
+auto s_raw_array() -> std::unique_ptr<clara::Serializer>
+{
+    return std::make_unique<RawArraySerializer<T>>();
+}
+
 } // end namespace
 
 // ---------------------------------------------------------------------------
 
+namespace clara {
+
+auto EngineDataType::register_mime_type(const std::string& mime_type) -> int
+{
+    // function statics, the predefined types are registered on static init
+    static std::mutex mutex;
+    static std::unordered_map<std::string, int> ids;
+
+    std::unique_lock<std::mutex> lock{mutex};
+    auto [it, inserted] = ids.try_emplace(mime_type, static_cast<int>(ids.size()));
+    return it->second;
+}
+
+} // end namespace clara
+
+// ---------------------------------------------------------------------------
+
 namespace clara::type {
 
 namespace mt = msg::mimetype;
@@ -96,4 +272,11 @@ const EngineDataType BYTES { "binary/bytes", std::make_unique<RawBytesSerializer
 
 const EngineDataType JSON { "application/json", std::make_unique<StringSerializer>() };
 
+const EngineDataType ARRAY_INT32 { "binary/raw-array-int32", s_raw_array<std::int32_t>() };
+const EngineDataType ARRAY_INT64 { "binary/raw-array-int64", s_raw_array<std::int64_t>() };
+const EngineDataType ARRAY_FLOAT { "binary/raw-array-float", s_raw_array<float>() };
+const EngineDataType ARRAY_DOUBLE { "binary/raw-array-double", s_raw_array<double>() };
+
+const EngineDataType RECORD_BATCH { "binary/record-batch", std::make_unique<RecordBatchSerializer>() };
+
 } // end namespace clara::type
@@ -44,6 +44,8 @@ auto JsonReport::generate(const DpeReport& report) const -> std::string
     put(writer, "cpu_usage", report.cpu_usage());
     put(writer, "memory_usage", report.memory_usage());
     put(writer, "load", report.load());
+    put(writer, "buffer_pool_hit_rate", report.buffer_pool_hit_rate());
+    put(writer, "buffer_pool_resident_bytes", report.buffer_pool_resident_bytes());
     writer.Key(containers_key.data(), containers_key.size());
     writer.StartArray();
     for (const auto& cr : report.containers()) {
@@ -66,6 +68,13 @@ auto JsonReport::generate(const DpeReport& report) const -> std::string
             put(writer, "bytes_recv", sr->bytes_recv());
             put(writer, "bytes_sent", sr->bytes_sent());
             put(writer, "exec_time", sr->exec_time());
+            put(writer, "input_reads", sr->input_reads());
+            put(writer, "input_skips", sr->input_skips());
+            put(writer, "output_writes", sr->output_writes());
+            put(writer, "output_reuses", sr->output_reuses());
+            for (const auto& [key, value] : sr->engine_stats()) {
+                put(writer, key, value);
+            }
             writer.EndObject();
         }
         writer.EndArray();
@@ -0,0 +1,111 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_MESSAGE_POOL_HPP
+#define CLARA_MESSAGE_POOL_HPP
+
+#include <clara/msg/message.hpp>
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace clara::util {
+
+/**
+ * Reusable message slots, recycled through a free list.
+ *
+ * A slot keeps its buffers when it is released, and the caller swaps
+ * the received message into the slot instead of allocating a new one.
+ * Once enough slots are created, acquiring and releasing them does not
+ * allocate.
+ */
+class MessagePool
+{
+public:
+    explicit MessagePool(std::size_t size)
+    {
+        slots_.reserve(size);
+        free_.reserve(size);
+        for (std::size_t i = 0; i < size; ++i) {
+            free_.push_back(create_slot());
+        }
+    }
+
+    MessagePool(const MessagePool&) = delete;
+    auto operator=(const MessagePool&) -> MessagePool& = delete;
+
+    ~MessagePool() = default;
+
+public:
+    auto acquire() -> msg::Message*
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        if (free_.empty()) {
+            auto* slot = create_slot();
+            free_.reserve(slots_.size());
+            return slot;
+        }
+        auto* slot = free_.back();
+        free_.pop_back();
+        return slot;
+    }
+
+    void release(msg::Message* slot)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        free_.push_back(slot);
+    }
+
+    /**
+     * Swaps the received message into a free slot, and posts a task to
+     * process the slot in the given thread pool. The slot is released when
+     * the task is done. The received message gets the old buffers of the
+     * slot back, to receive the next message into them.
+     *
+     * Returns false if the queue of the thread pool is full.
+     */
+    template<typename ThreadPool, typename Handler>
+    auto post(ThreadPool& pool, msg::Message& msg, Handler handler) -> bool
+    {
+        auto* slot = acquire();
+        swap(*slot, msg);
+        auto posted = pool.tryPost([this, slot, handler]() {
+            handler(*slot);
+            release(slot);
+        });
+        if (!posted) {
+            release(slot);
+        }
+        return posted;
+    }
+
+    auto size() -> std::size_t
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        return slots_.size();
+    }
+
+private:
+    auto create_slot() -> msg::Message*
+    {
+        slots_.push_back(std::make_unique<msg::Message>(
+                msg::Topic::raw(""),
+                msg::proto::make_meta(),
+                std::vector<std::uint8_t>{}));
+        return slots_.back().get();
+    }
+
+private:
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<msg::Message>> slots_;
+    std::vector<msg::Message*> free_;
+};
+
+} // end namespace clara::util
+
+#endif // end of include guard: CLARA_MESSAGE_POOL_HPP
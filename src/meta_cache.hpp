@@ -0,0 +1,99 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_META_CACHE_HPP
+#define CLARA_META_CACHE_HPP
+
+#include <clara/msg/proto/meta.hpp>
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace clara::util {
+
+/**
+ * Released metadata objects of the current thread, ready to be reused.
+ *
+ * Every event needs a few metadata objects (the input and output data and
+ * the output message). A cleared protobuf message keeps the memory of its
+ * string fields, so copying new values into a recycled object does not
+ * allocate once the thread has processed a few events.
+ */
+class MetaCache
+{
+public:
+    using Meta = msg::proto::Meta;
+    using MetaPtr = std::unique_ptr<Meta>;
+
+    static constexpr std::size_t capacity = 16;
+
+public:
+    /**
+     * Gets an empty metadata object.
+     */
+    static auto acquire() -> MetaPtr
+    {
+        auto* cache = local();
+        if (cache == nullptr || cache->metas_.empty()) {
+            return msg::proto::make_meta();
+        }
+        auto meta = std::move(cache->metas_.back());
+        cache->metas_.pop_back();
+        return meta;
+    }
+
+    /**
+     * Gets a copy of the given metadata object.
+     */
+    static auto acquire(const Meta& other) -> MetaPtr
+    {
+        auto meta = acquire();
+        meta->CopyFrom(other);
+        return meta;
+    }
+
+    /**
+     * Returns a metadata object to the cache of the current thread.
+     * The object is deleted if the cache is full.
+     */
+    static void release(MetaPtr&& meta)
+    {
+        auto* cache = local();
+        if (meta && cache != nullptr && cache->metas_.size() < capacity) {
+            meta->Clear();
+            cache->metas_.push_back(std::move(meta));
+        }
+        meta.reset();
+    }
+
+private:
+    MetaCache()
+    {
+        metas_.reserve(capacity);
+    }
+
+    ~MetaCache()
+    {
+        destroyed = true;
+    }
+
+    // null when the thread is exiting and the cache was already destroyed
+    static auto local() -> MetaCache*
+    {
+        thread_local MetaCache cache;
+        return destroyed ? nullptr : &cache;
+    }
+
+private:
+    static inline thread_local bool destroyed = false;
+
+    std::vector<MetaPtr> metas_;
+};
+
+} // end namespace clara::util
+
+#endif // end of include guard: CLARA_META_CACHE_HPP
@@ -0,0 +1,237 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/msg/buffer_pool.hpp>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+namespace {
+
+using Buffer = clara::msg::BufferPool::Buffer;
+using BufferPool = clara::msg::BufferPool;
+
+constexpr int min_class = 12;
+constexpr int max_class = 28;
+constexpr int n_classes = max_class - min_class + 1;
+
+static_assert(BufferPool::min_size == std::size_t{1} << min_class);
+static_assert(BufferPool::max_size == std::size_t{1} << max_class);
+
+constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+
+std::atomic<std::uint64_t> n_hits{0};
+std::atomic<std::uint64_t> n_misses{0};
+std::atomic<std::uint64_t> resident_bytes{0};
+std::atomic<bool> use_huge_pages{false};
+
+
+// the smallest class that fits the requested size
+auto acquire_class(std::size_t size) -> int
+{
+    auto cls = min_class;
+    while ((std::size_t{1} << cls) < size) {
+        ++cls;
+    }
+    return cls - min_class;
+}
+
+
+// the largest class that fits in the capacity of the released buffer
+auto release_class(std::size_t capacity) -> int
+{
+    auto cls = min_class;
+    while (cls < max_class && (std::size_t{1} << (cls + 1)) <= capacity) {
+        ++cls;
+    }
+    return cls - min_class;
+}
+
+
+void advise_huge_pages(void* data, std::size_t size)
+{
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+    // only the whole huge pages inside the buffer can be advised
+    auto addr = reinterpret_cast<std::uintptr_t>(data);  // NOLINT
+    auto begin = (addr + huge_page_size - 1) & ~(huge_page_size - 1);
+    auto end = (addr + size) & ~(huge_page_size - 1);
+    if (end > begin) {
+        ::madvise(reinterpret_cast<void*>(begin), end - begin, MADV_HUGEPAGE);  // NOLINT
+    }
+#else
+    (void) data;
+    (void) size;
+#endif
+}
+
+
+auto allocate(std::size_t size) -> Buffer
+{
+    auto buffer = Buffer{};
+    buffer.reserve(size);
+    if (size >= huge_page_size && use_huge_pages.load(std::memory_order_relaxed)) {
+        advise_huge_pages(buffer.data(), buffer.capacity());
+    }
+    return buffer;
+}
+
+
+class SharedPool
+{
+public:
+    void push(int cls, Buffer&& buffer)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        buffers_[cls].push_back(std::move(buffer));
+    }
+
+    auto pop(int cls, Buffer& buffer) -> bool
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        auto& list = buffers_[cls];
+        if (list.empty()) {
+            return false;
+        }
+        buffer = std::move(list.back());
+        list.pop_back();
+        return true;
+    }
+
+private:
+    std::mutex mutex_;
+    std::array<std::vector<Buffer>, n_classes> buffers_;
+};
+
+
+// never destroyed, since messages can be destroyed by static destructors
+auto shared_pool() -> SharedPool&
+{
+    static auto* pool = new SharedPool{};
+    return *pool;
+}
+
+
+thread_local bool local_destroyed = false;
+
+
+// one buffer per class, for the current thread
+class LocalCache
+{
+public:
+    ~LocalCache()
+    {
+        local_destroyed = true;
+        for (int cls = 0; cls < n_classes; ++cls) {
+            if (buffers_[cls].capacity() > 0) {
+                shared_pool().push(cls, std::move(buffers_[cls]));
+            }
+        }
+    }
+
+    auto pop(int cls, Buffer& buffer) -> bool
+    {
+        if (buffers_[cls].capacity() == 0) {
+            return false;
+        }
+        buffer = std::move(buffers_[cls]);
+        return true;
+    }
+
+    auto push(int cls, Buffer& buffer) -> bool
+    {
+        if (buffers_[cls].capacity() > 0) {
+            return false;
+        }
+        buffers_[cls] = std::move(buffer);
+        return true;
+    }
+
+private:
+    std::array<Buffer, n_classes> buffers_;
+};
+
+
+// null when the thread is exiting and the cache was already destroyed
+auto local_cache() -> LocalCache*
+{
+    thread_local LocalCache cache;
+    return local_destroyed ? nullptr : &cache;
+}
+
+} // end namespace
+
+
+namespace clara::msg {
+
+auto BufferPool::acquire(std::size_t size) -> Buffer
+{
+    // smaller sizes get a buffer of the smallest class
+    if (size == 0 || size > max_size) {
+        auto buffer = Buffer{};
+        buffer.reserve(size);
+        return buffer;
+    }
+
+    auto cls = acquire_class(size);
+    auto buffer = Buffer{};
+    auto* local = local_cache();
+    if ((local != nullptr && local->pop(cls, buffer)) || shared_pool().pop(cls, buffer)) {
+        n_hits.fetch_add(1, std::memory_order_relaxed);
+        resident_bytes.fetch_sub(buffer.capacity(), std::memory_order_relaxed);
+        return buffer;
+    }
+
+    n_misses.fetch_add(1, std::memory_order_relaxed);
+    return allocate(std::size_t{1} << (cls + min_class));
+}
+
+
+void BufferPool::release(Buffer&& buffer)
+{
+    auto recycled = std::move(buffer);
+    auto capacity = recycled.capacity();
+    if (capacity < min_size || capacity > max_size) {
+        return;
+    }
+
+    auto total = resident_bytes.fetch_add(capacity, std::memory_order_relaxed) + capacity;
+    if (total > max_resident_bytes) {
+        resident_bytes.fetch_sub(capacity, std::memory_order_relaxed);
+        return;
+    }
+
+    recycled.clear();
+    auto cls = release_class(capacity);
+    auto* local = local_cache();
+    if (local == nullptr || !local->push(cls, recycled)) {
+        shared_pool().push(cls, std::move(recycled));
+    }
+}
+
+
+void BufferPool::set_huge_pages(bool enable)
+{
+    use_huge_pages.store(enable, std::memory_order_relaxed);
+}
+
+
+auto BufferPool::stats() -> Stats
+{
+    return {
+        n_hits.load(std::memory_order_relaxed),
+        n_misses.load(std::memory_order_relaxed),
+        resident_bytes.load(std::memory_order_relaxed),
+    };
+}
+
+} // end namespace clara::msg
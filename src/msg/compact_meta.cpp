@@ -0,0 +1,259 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/msg/proto/meta.hpp>
+
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+// The compact format (all numbers are little-endian):
+//
+//  0  marker (uint8, always zero)
+//  1  version (uint8)
+//  2  presence bits of the numeric fields (uint16)
+//  4  status, action, control and byte order (uint8 each)
+//  8  severity ID (int32)
+// 12  communication ID (uint32)
+// 16  execution time (int64)
+// 24  datatype, author, version, composition, replyto, description,
+//     sender, sender state and datatype description
+//     (uint32 length, or absent_string if not set, followed by the bytes)
+
+namespace {
+
+using Meta = clara::msg::proto::Meta;
+
+constexpr std::uint8_t format_version = 1;
+constexpr std::size_t fixed_size = 24;
+constexpr std::uint32_t absent_string = std::numeric_limits<std::uint32_t>::max();
+
+enum Field : std::uint16_t
+{
+    status_bit = 1U << 0U,
+    action_bit = 1U << 1U,
+    control_bit = 1U << 2U,
+    byte_order_bit = 1U << 3U,
+    severity_bit = 1U << 4U,
+    communication_id_bit = 1U << 5U,
+    execution_time_bit = 1U << 6U,
+};
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool big_endian = true;
+#else
+constexpr bool big_endian = false;
+#endif
+
+
+void check_byte_order()
+{
+    if constexpr (big_endian) {
+        throw std::runtime_error{"compact metadata requires a little-endian host"};
+    }
+}
+
+
+template<typename T>
+void put(char* out, std::size_t offset, T value)
+{
+    std::memcpy(out + offset, &value, sizeof(T));
+}
+
+
+template<typename T>
+auto get(const std::uint8_t* in, std::size_t offset) -> T
+{
+    auto value = T{};
+    std::memcpy(&value, in + offset, sizeof(T));
+    return value;
+}
+
+
+template<typename E>
+auto get_enum(std::uint8_t value, bool (*is_valid)(int)) -> E
+{
+    if (!is_valid(value)) {
+        throw std::invalid_argument{"invalid enum value in compact metadata"};
+    }
+    return static_cast<E>(value);
+}
+
+
+auto string_size(bool present, const std::string& value) -> std::size_t
+{
+    return sizeof(std::uint32_t) + (present ? value.size() : 0);
+}
+
+
+void put_string(std::string& buffer, bool present, const std::string& value)
+{
+    auto size = present ? static_cast<std::uint32_t>(value.size()) : absent_string;
+    buffer.append(reinterpret_cast<const char*>(&size), sizeof(size));  // NOLINT
+    if (present) {
+        buffer.append(value);
+    }
+}
+
+
+class StringReader
+{
+public:
+    StringReader(const std::uint8_t* data, std::size_t size)
+      : it_{data + fixed_size}
+      , end_{data + size}
+    {
+        // nop
+    }
+
+    // returns false if the string is absent
+    auto next(std::string* value) -> bool
+    {
+        auto size = std::uint32_t{};
+        std::memcpy(&size, take(sizeof(size)), sizeof(size));
+        if (size == absent_string) {
+            return false;
+        }
+        const auto* bytes = take(size);
+        value->assign(reinterpret_cast<const char*>(bytes), size);  // NOLINT
+        return true;
+    }
+
+private:
+    auto take(std::size_t size) -> const std::uint8_t*
+    {
+        if (size > static_cast<std::size_t>(end_ - it_)) {
+            throw std::invalid_argument{"truncated compact metadata"};
+        }
+        const auto* data = it_;
+        it_ += size;
+        return data;
+    }
+
+private:
+    const std::uint8_t* it_;
+    const std::uint8_t* end_;
+};
+
+} // end namespace
+
+
+namespace clara::msg::proto::detail {
+
+void write_compact_meta(const Meta& meta, std::string& buffer)
+{
+    check_byte_order();
+
+    auto fields = std::uint16_t{0};
+    auto set_field = [&fields](bool present, Field field) {
+        if (present) {
+            fields |= field;
+        }
+    };
+    set_field(meta.has_status(), status_bit);
+    set_field(meta.has_action(), action_bit);
+    set_field(meta.has_control(), control_bit);
+    set_field(meta.has_byteorder(), byte_order_bit);
+    set_field(meta.has_severityid(), severity_bit);
+    set_field(meta.has_communicationid(), communication_id_bit);
+    set_field(meta.has_executiontime(), execution_time_bit);
+
+    auto size = fixed_size
+              + string_size(meta.has_datatype(), meta.datatype())
+              + string_size(meta.has_author(), meta.author())
+              + string_size(meta.has_version(), meta.version())
+              + string_size(meta.has_composition(), meta.composition())
+              + string_size(meta.has_replyto(), meta.replyto())
+              + string_size(meta.has_description(), meta.description())
+              + string_size(meta.has_sender(), meta.sender())
+              + string_size(meta.has_senderstate(), meta.senderstate())
+              + string_size(meta.has_dattypedescription(), meta.dattypedescription());
+
+    buffer.clear();
+    buffer.reserve(size);
+    buffer.resize(fixed_size);
+
+    auto* out = buffer.data();
+    put<std::uint8_t>(out, 0, compact_meta_marker);
+    put<std::uint8_t>(out, 1, format_version);
+    put<std::uint16_t>(out, 2, fields);
+    put<std::uint8_t>(out, 4, static_cast<std::uint8_t>(meta.status()));
+    put<std::uint8_t>(out, 5, static_cast<std::uint8_t>(meta.action()));
+    put<std::uint8_t>(out, 6, static_cast<std::uint8_t>(meta.control()));
+    put<std::uint8_t>(out, 7, static_cast<std::uint8_t>(meta.byteorder()));
+    put<std::int32_t>(out, 8, meta.severityid());
+    put<std::uint32_t>(out, 12, meta.communicationid());
+    put<std::int64_t>(out, 16, meta.executiontime());
+
+    put_string(buffer, meta.has_datatype(), meta.datatype());
+    put_string(buffer, meta.has_author(), meta.author());
+    put_string(buffer, meta.has_version(), meta.version());
+    put_string(buffer, meta.has_composition(), meta.composition());
+    put_string(buffer, meta.has_replyto(), meta.replyto());
+    put_string(buffer, meta.has_description(), meta.description());
+    put_string(buffer, meta.has_sender(), meta.sender());
+    put_string(buffer, meta.has_senderstate(), meta.senderstate());
+    put_string(buffer, meta.has_dattypedescription(), meta.dattypedescription());
+}
+
+
+void read_compact_meta(const void* data, std::size_t size, Meta& meta)
+{
+    check_byte_order();
+
+    const auto* in = static_cast<const std::uint8_t*>(data);
+    if (size < fixed_size || in[0] != compact_meta_marker) {
+        throw std::invalid_argument{"invalid compact metadata"};
+    }
+    if (in[1] != format_version) {
+        throw std::invalid_argument{"unsupported compact metadata version"};
+    }
+
+    meta.Clear();
+
+    auto fields = get<std::uint16_t>(in, 2);
+    if ((fields & status_bit) != 0) {
+        meta.set_status(get_enum<Meta::Status>(in[4], Meta::Status_IsValid));
+    }
+    if ((fields & action_bit) != 0) {
+        meta.set_action(get_enum<Meta::ControlAction>(in[5], Meta::ControlAction_IsValid));
+    }
+    if ((fields & control_bit) != 0) {
+        meta.set_control(get_enum<Meta::SubControlAction>(in[6], Meta::SubControlAction_IsValid));
+    }
+    if ((fields & byte_order_bit) != 0) {
+        meta.set_byteorder(get_enum<Meta::Endian>(in[7], Meta::Endian_IsValid));
+    }
+    if ((fields & severity_bit) != 0) {
+        meta.set_severityid(get<std::int32_t>(in, 8));
+    }
+    if ((fields & communication_id_bit) != 0) {
+        meta.set_communicationid(get<std::uint32_t>(in, 12));
+    }
+    if ((fields & execution_time_bit) != 0) {
+        meta.set_executiontime(get<std::int64_t>(in, 16));
+    }
+
+    // the strings are read into the mutable fields to reuse their memory,
+    // and cleared again if they are not present
+    auto reader = StringReader{in, size};
+    auto read = [&reader](std::string* value, auto clear) {
+        if (!reader.next(value)) {
+            clear();
+        }
+    };
+    read(meta.mutable_datatype(), [&] { meta.clear_datatype(); });
+    read(meta.mutable_author(), [&] { meta.clear_author(); });
+    read(meta.mutable_version(), [&] { meta.clear_version(); });
+    read(meta.mutable_composition(), [&] { meta.clear_composition(); });
+    read(meta.mutable_replyto(), [&] { meta.clear_replyto(); });
+    read(meta.mutable_description(), [&] { meta.clear_description(); });
+    read(meta.mutable_sender(), [&] { meta.clear_sender(); });
+    read(meta.mutable_senderstate(), [&] { meta.clear_senderstate(); });
+    read(meta.mutable_dattypedescription(), [&] { meta.clear_dattypedescription(); });
+}
+
+} // end namespace clara::msg::proto::detail
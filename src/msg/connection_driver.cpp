@@ -86,8 +86,15 @@ void ProxyDriver::connect()
 
 void ProxyDriver::send(Message& msg)
 {
+    // the buffer of the serialized metadata is reused for every message
+    thread_local auto m = std::string{};
+
     const auto& t = msg.topic().str();
-    const auto& m = msg.meta()->SerializeAsString();
+    if (msg.compact_meta()) {
+        proto::detail::write_compact_meta(*msg.meta(), m);
+    } else {
+        msg.meta()->SerializeToString(&m);
+    }
     const auto& d = msg.data();
 
     using zmq::send_flags;
@@ -157,10 +164,22 @@ auto parse_message(RawMessage& multi_msg) -> Message
 {
     auto topic = detail::to_string(multi_msg[0]);
     auto meta = proto::make_meta();
-    meta->ParseFromArray(multi_msg[1].data(), static_cast<int>(multi_msg[1].size()));
+    proto::detail::parse_meta(multi_msg[1].data(), multi_msg[1].size(), *meta);
     auto data = detail::to_bytes(multi_msg[2]);
 
     return {Topic::raw(topic), std::move(meta), std::move(data)};
 }
 
+
+void parse_message(RawMessage& raw_msg, Message& msg)
+{
+    const auto& meta = raw_msg[1];
+    const auto& data = raw_msg[2];
+
+    assign_message(msg,
+                   detail::to_string_view(raw_msg[0]),
+                   meta.data(), meta.size(),
+                   data.data(), data.size());
+}
+
 } // end namespace clara::msg::detail
@@ -71,6 +71,8 @@ private:
 
 auto parse_message(RawMessage& msg) -> Message;
 
+void parse_message(RawMessage& raw_msg, Message& msg);
+
 } // end namespace clara::msg::detail
 
 #endif // CLARA_MSG_CONNECTION_DRIVER_H_
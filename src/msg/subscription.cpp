@@ -59,12 +59,16 @@ void Subscription::run()
 {
     auto poller = detail::BasicPoller{connection_->sub_socket()};
     const int timeout = 100;
+
+    // reused to receive all messages, the handler can keep or swap the content
+    auto msg = Message{Topic::raw(""), proto::make_meta(), std::vector<std::uint8_t>{}};
+
     while (is_alive_.load()) {
         try {
             if (poller.poll(timeout)) {
                 auto raw_msg = connection_->recv();
                 if (CLARA_LIKELY(raw_msg.size() == 3)) {
-                    auto msg = detail::parse_message(raw_msg);
+                    detail::parse_message(raw_msg, msg);
                     handler_(msg);
                 }
             }
@@ -0,0 +1,298 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/record_batch.hpp>
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+namespace {
+
+constexpr std::uint8_t magic[] = {'C', 'R', 'B', '1'};
+
+constexpr std::size_t fixed_header_size = sizeof(magic) + 4 + 8;
+constexpr std::size_t fixed_column_size = 1 + 4 + 8 + 8;
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+constexpr bool big_endian = true;
+#else
+constexpr bool big_endian = false;
+#endif
+
+
+void check_byte_order()
+{
+    if constexpr (big_endian) {
+        throw std::runtime_error{"record batches require a little-endian host"};
+    }
+}
+
+
+auto align(std::size_t size) -> std::size_t
+{
+    const auto a = clara::RecordBatch::alignment;
+    return (size + a - 1) / a * a;
+}
+
+
+auto element_size(clara::ColumnType type) -> std::size_t
+{
+    switch (type) {
+        case clara::ColumnType::INT8:
+            return 1;
+        case clara::ColumnType::INT16:
+            return 2;
+        case clara::ColumnType::INT32:
+        case clara::ColumnType::FLOAT:
+            return 4;
+        case clara::ColumnType::INT64:
+        case clara::ColumnType::DOUBLE:
+            return 8;
+        default:
+            throw std::invalid_argument{"invalid column type"};
+    }
+}
+
+
+// checks that the column holds one value per row,
+// without overflowing when the number of rows is too large
+auto valid_size(std::size_t rows, clara::ColumnType type,
+                std::size_t size, std::size_t max_size) -> bool
+{
+    auto element = element_size(type);
+    if (rows > max_size / element) {
+        return false;
+    }
+    return size == rows * element;
+}
+
+
+template<typename T>
+void put(std::uint8_t*& out, T value)
+{
+    std::memcpy(out, &value, sizeof(T));
+    out += sizeof(T);
+}
+
+
+class Reader
+{
+public:
+    Reader(const std::uint8_t* data, std::size_t size)
+      : begin_{data}
+      , it_{data}
+      , end_{data + size}
+    {
+        // nop
+    }
+
+    template<typename T>
+    auto get() -> T
+    {
+        auto value = T{};
+        std::memcpy(&value, take(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    auto get_string(std::size_t size) -> std::string
+    {
+        const auto* data = take(size);
+        return {reinterpret_cast<const char*>(data), size};  // NOLINT
+    }
+
+    auto take(std::size_t size) -> const std::uint8_t*
+    {
+        if (size > static_cast<std::size_t>(end_ - it_)) {
+            throw std::invalid_argument{"truncated record batch header"};
+        }
+        const auto* data = it_;
+        it_ += size;
+        return data;
+    }
+
+    auto position() const -> std::size_t
+    {
+        return static_cast<std::size_t>(it_ - begin_);
+    }
+
+private:
+    const std::uint8_t* begin_;
+    const std::uint8_t* it_;
+    const std::uint8_t* end_;
+};
+
+} // end namespace
+
+
+namespace clara {
+
+auto RecordBatch::read(Buffer&& buffer) -> RecordBatch
+{
+    auto batch = RecordBatch{};
+    auto data_offset = batch.read_header(buffer);
+    auto data_size = buffer.size() - data_offset;
+
+    // the blocks are moved inside the buffer if they are not aligned,
+    // and copied only if there is no room for that
+    auto address = reinterpret_cast<std::uintptr_t>(buffer.data() + data_offset);
+    auto shift = static_cast<std::size_t>((alignment - address % alignment) % alignment);
+    if (shift > 0 && buffer.capacity() - buffer.size() < shift) {
+        batch.data_.assign(buffer.begin() + static_cast<std::ptrdiff_t>(data_offset),
+                           buffer.end());
+        return batch;
+    }
+    if (shift > 0) {
+        buffer.resize(buffer.size() + shift);
+        std::memmove(buffer.data() + data_offset + shift,
+                     buffer.data() + data_offset, data_size);
+    }
+    batch.received_ = std::make_shared<const Buffer>(std::move(buffer));
+    batch.received_offset_ = data_offset + shift;
+    return batch;
+}
+
+
+auto RecordBatch::read(const Buffer& buffer) -> RecordBatch
+{
+    auto batch = RecordBatch{};
+    auto data_offset = batch.read_header(buffer);
+
+    // the column blocks are copied with a single memcpy
+    batch.data_.assign(buffer.begin() + static_cast<std::ptrdiff_t>(data_offset), buffer.end());
+    return batch;
+}
+
+
+auto RecordBatch::read_header(const Buffer& buffer) -> std::size_t
+{
+    check_byte_order();
+
+    auto reader = Reader{buffer.data(), buffer.size()};
+    if (!std::equal(std::begin(magic), std::end(magic), reader.take(sizeof(magic)))) {
+        throw std::invalid_argument{"invalid record batch magic"};
+    }
+
+    auto n_columns = reader.get<std::uint32_t>();
+    rows_ = static_cast<std::size_t>(reader.get<std::uint64_t>());
+    columns_.reserve(n_columns);
+    for (std::uint32_t i = 0; i < n_columns; ++i) {
+        auto type = static_cast<ColumnType>(reader.get<std::uint8_t>());
+        auto name = reader.get_string(reader.get<std::uint32_t>());
+        auto offset = static_cast<std::size_t>(reader.get<std::uint64_t>());
+        auto size = static_cast<std::size_t>(reader.get<std::uint64_t>());
+        if (!valid_size(rows_, type, size, buffer.size())) {
+            throw std::invalid_argument{"invalid size of column " + name};
+        }
+        columns_.push_back({std::move(name), type, offset, size});
+    }
+
+    auto data_offset = align(reader.position());
+    if (data_offset > buffer.size()) {
+        throw std::invalid_argument{"truncated record batch header"};
+    }
+    auto data_size = buffer.size() - data_offset;
+    for (const auto& col : columns_) {
+        if (col.offset % alignment != 0 ||
+                col.offset > data_size || col.size > data_size - col.offset) {
+            throw std::invalid_argument{"invalid offset of column " + col.name};
+        }
+    }
+    return data_offset;
+}
+
+
+void RecordBatch::write(Buffer& buffer) const
+{
+    check_byte_order();
+
+    auto header = header_size();
+    auto data_size = blocks_size();
+    buffer.resize(header + data_size);
+
+    auto* out = buffer.data();
+    out = std::copy(std::begin(magic), std::end(magic), out);
+    put(out, static_cast<std::uint32_t>(columns_.size()));
+    put(out, static_cast<std::uint64_t>(rows_));
+    for (const auto& col : columns_) {
+        put(out, static_cast<std::uint8_t>(col.type));
+        put(out, static_cast<std::uint32_t>(col.name.size()));
+        out = std::copy(col.name.begin(), col.name.end(), out);
+        put(out, static_cast<std::uint64_t>(col.offset));
+        put(out, static_cast<std::uint64_t>(col.size));
+    }
+    std::fill(out, buffer.data() + header, std::uint8_t{0});
+
+    // the column blocks are copied with a single memcpy
+    if (data_size > 0) {
+        std::memcpy(buffer.data() + header, blocks(), data_size);
+    }
+}
+
+
+auto RecordBatch::serialized_size() const -> std::size_t
+{
+    return header_size() + blocks_size();
+}
+
+
+void RecordBatch::add_column(std::string_view name, ColumnType type,
+                             const void* data, std::size_t size)
+{
+    if (find(name) != nullptr) {
+        throw std::invalid_argument{"repeated column " + std::string{name}};
+    }
+    if (!valid_size(rows_, type, size, std::numeric_limits<std::size_t>::max())) {
+        throw std::invalid_argument{"invalid size of column " + std::string{name}};
+    }
+
+    // the new column needs the blocks in owned memory
+    if (received_) {
+        data_.assign(blocks(), blocks() + blocks_size());
+        received_.reset();
+        received_offset_ = 0;
+    }
+
+    auto offset = align(data_.size());
+    data_.resize(offset + size, 0);
+    if (size > 0) {
+        std::memcpy(data_.data() + offset, data, size);
+    }
+    columns_.push_back({std::string{name}, type, offset, size});
+}
+
+
+auto RecordBatch::find(std::string_view name) const -> const Column*
+{
+    auto it = std::find_if(columns_.begin(), columns_.end(),
+                           [&](const auto& c) { return c.name == name; });
+    return it != columns_.end() ? &*it : nullptr;
+}
+
+
+auto RecordBatch::get(std::string_view name, ColumnType type) const -> const Column*
+{
+    const auto* col = find(name);
+    if (col == nullptr) {
+        throw std::invalid_argument{"missing column " + std::string{name}};
+    }
+    if (col->type != type) {
+        throw std::invalid_argument{"invalid type of column " + std::string{name}};
+    }
+    return col;
+}
+
+
+auto RecordBatch::header_size() const -> std::size_t
+{
+    auto size = fixed_header_size;
+    for (const auto& col : columns_) {
+        size += fixed_column_size + col.name.size();
+    }
+    return align(size);
+}
+
+} // end namespace clara
@@ -7,6 +7,7 @@
 #include "dpe.hpp"
 #include "dpe_options.hpp"
 
+#include <clara/msg/buffer_pool.hpp>
 #include <clara/msg/context.hpp>
 
 #include <csignal>
@@ -41,6 +42,8 @@ int main(int argc, char** argv)
     ctx->set_io_threads(options.io_threads());
     ctx->set_max_sockets(options.max_sockets());
 
+    clara::msg::BufferPool::set_huge_pages(options.huge_pages());
+
     clara::Dpe dpe{false,
                    options.local_address(),
                    options.frontend_address(),
@@ -8,6 +8,8 @@
 
 #include "logging.hpp"
 
+#include <stdexcept>
+
 
 static constexpr auto default_queue_size = 1024;
 
@@ -22,13 +24,44 @@ static auto thread_pool_options(int pool_size, int queue_size)
 }
 
 
+// With one engine per worker, the first instance is owned by the loader.
+// Worker i will run the engine at index i of the returned list.
+static auto create_instances(const clara::ServiceLoader& loader,
+                             const clara::ServiceParameters& params)
+    -> std::vector<clara::ServiceLoader::EnginePtr>
+{
+    auto instances = std::vector<clara::ServiceLoader::EnginePtr>{};
+    if (params.engine_per_worker) {
+        for (int i = 1; i < params.pool_size; ++i) {
+            instances.push_back(loader.create());
+        }
+    }
+    return instances;
+}
+
+
+static auto list_engines(const clara::ServiceLoader& loader,
+                         const std::vector<clara::ServiceLoader::EnginePtr>& instances)
+    -> std::vector<clara::Engine*>
+{
+    auto engines = std::vector<clara::Engine*>{loader.get()};
+    for (const auto& e : instances) {
+        engines.push_back(e.get());
+    }
+    return engines;
+}
+
+
 namespace clara {
 
 Service::Service(const Component& self,
                  const Component& frontend,
-                 const ServiceParameters& params)
+                 const ServiceParameters& params,
+                 ServiceRegistry* registry)
   : Base{self, frontend}
   , loader_{params.engine_lib}
+  , instances_{create_instances(loader_, params)}
+  , messages_{static_cast<std::size_t>(params.pool_size)}
   , thread_pool_{thread_pool_options(params.pool_size, default_queue_size)}
   , sys_config_{std::make_shared<ServiceConfig>()}
   , report_{std::make_shared<ServiceReport>(name(), params,
@@ -36,11 +69,13 @@ Service::Service(const Component& self,
                                             loader_->version(),
                                             loader_->description())}
   , service_{std::make_unique<ServiceEngine>(self, frontend,
-                                             loader_.get(),
+                                             list_engines(loader_, instances_),
                                              report_.get(),
-                                             sys_config_.get())}
+                                             sys_config_.get(),
+                                             registry)}
 {
-    LOGGER->info("created service = %s pool_size = %d", name(), params.pool_size);
+    LOGGER->info("created service = %s pool_size = %d engines = %d",
+                 name(), params.pool_size, int(instances_.size()) + 1);
 }
 
 
@@ -104,16 +139,39 @@ void Service::configure(msg::Message& msg)
 
 void Service::execute(msg::Message& msg)
 {
-    auto m = std::make_unique<msg::Message>(std::move(msg));
-    thread_pool_.post([s=service_.get(), m=std::move(m)]() {
+    // the received message is swapped into a recycled slot,
+    // and the subscription gets the old buffers back to receive the next one
+    auto posted = messages_.post(thread_pool_, msg, [s=service_.get()](msg::Message& m) {
         try {
-            s->execute(*m);
+            s->execute(m);
         } catch (const std::exception& e) {
             LOGGER->error("%s execute: unhandled exception %s", s->name(), e.what());
         } catch (...) {
             LOGGER->error("%s execute: unexpected exception", s->name());
         }
     });
+    if (!posted) {
+        throw std::runtime_error{"thread pool queue is full"};
+    }
+}
+
+
+auto Service::accepts(const EngineData& data) const -> bool
+{
+    return service_->accepts(data);
+}
+
+
+auto Service::try_execute(EngineData& data) -> bool
+{
+    try {
+        return service_->try_execute(data);
+    } catch (const std::exception& e) {
+        LOGGER->error("%s execute: unhandled exception %s", name(), e.what());
+    } catch (...) {
+        LOGGER->error("%s execute: unexpected exception", name());
+    }
+    return true;
 }
 
 
@@ -11,6 +11,7 @@
 
 #include "base.hpp"
 #include "concurrent_utils.hpp"
+#include "message_pool.hpp"
 #include "service_config.hpp"
 #include "service_engine.hpp"
 #include "service_loader.hpp"
@@ -18,6 +19,7 @@
 
 #include <memory>
 #include <mutex>
+#include <vector>
 
 namespace clara {
 
@@ -26,7 +28,8 @@ class Service : public Base
 public:
     Service(const Component& self,
             const Component& frontend,
-            const ServiceParameters& params);
+            const ServiceParameters& params,
+            ServiceRegistry* registry = nullptr);
 
     Service(const Service&) = delete;
 
@@ -47,6 +50,16 @@ public:
 
     void callback(msg::Message& msg);
 
+public:
+    /// Checks if the given data can be executed in-process by this service.
+    auto accepts(const EngineData& data) const -> bool;
+
+    /// Executes the given data in the caller thread, if the service accepts it
+    /// and not all its workers are already running data of other services.
+    /// The data was published by a co-located service and it is not serialized.
+    /// Returns false if the data must be sent to the service instead.
+    auto try_execute(EngineData& data) -> bool;
+
 public:
     auto report() const -> std::shared_ptr<ServiceReport>;
 
@@ -55,6 +68,8 @@ private:
     std::mutex cb_mutex_;
 
     ServiceLoader loader_;
+    std::vector<ServiceLoader::EnginePtr> instances_;
+    util::MessagePool messages_;
     util::ThreadPool thread_pool_;
 
     std::shared_ptr<ServiceConfig> sys_config_;
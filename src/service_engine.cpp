@@ -6,12 +6,18 @@
 
 #include "service_engine.hpp"
 
+#include "concurrent_utils.hpp"
 #include "data_utils.hpp"
 #include "logging.hpp"
+#include "meta_cache.hpp"
+#include "service.hpp"
 #include "service_config.hpp"
+#include "service_registry.hpp"
 #include "service_report.hpp"
 
+#include <algorithm>
 #include <chrono>
+#include <iterator>
 #include <stdexcept>
 
 
@@ -42,6 +48,75 @@ auto build_done_data(clara::EngineDataAccessor& accessor,
     return done_output;
 }
 
+
+// The services running a composition in the current thread.
+// A service that is already active cannot be fused again (i.e. loops).
+thread_local std::vector<const clara::ServiceEngine*> active_services;
+
+
+class ActiveService
+{
+public:
+    explicit ActiveService(const clara::ServiceEngine* service)
+    {
+        active_services.push_back(service);
+    }
+
+    ActiveService(const ActiveService&) = delete;
+    auto operator=(const ActiveService&) -> ActiveService& = delete;
+
+    ~ActiveService()
+    {
+        active_services.pop_back();
+    }
+};
+
+
+// The buffer of the last published output of this thread.
+// The message is already sent when it is recycled, so its buffer
+// and its metadata can be reused to serialize the next output.
+thread_local std::vector<std::uint8_t> output_buffer;
+
+
+void recycle_output(std::optional<clara::msg::Message>& output_msg)
+{
+    if (output_msg) {
+        output_buffer = output_msg->release_data();
+        clara::util::MetaCache::release(output_msg->release_meta());
+        output_msg.reset();
+    }
+}
+
+
+auto is_active(const clara::ServiceEngine* service) -> bool
+{
+    return std::find(active_services.begin(), active_services.end(), service) !=
+           active_services.end();
+}
+
+
+// releases an acquired permit
+class Permit
+{
+public:
+    explicit Permit(clara::util::Semaphore& permits)
+      : permits_{permits}
+    {
+        // nop
+    }
+
+    Permit(const Permit&) = delete;
+    auto operator=(const Permit&) -> Permit& = delete;
+
+    ~Permit()
+    {
+        permits_.release();
+    }
+
+private:
+    clara::util::Semaphore& permits_;
+};
+
 } // end namespace
 
 
@@ -49,22 +124,72 @@ namespace clara {
 
 ServiceEngine::ServiceEngine(const Component& self,
                              const Component& frontend,
-                             Engine* engine,
+                             std::vector<Engine*> engines,
                              ServiceReport* report,
-                             ServiceConfig* config)
+                             ServiceConfig* config,
+                             ServiceRegistry* registry)
   : Base{self, frontend}
-  , engine_{engine}
+  , engines_{std::move(engines)}
+  , engine_{engines_.front()}
+  , streaming_{dynamic_cast<StreamingEngine*>(engine_) != nullptr}
+  , emitter_guard_{std::make_shared<EmitterGuard>()}
   , report_{report}
   , config_{config}
+  , registry_{registry}
   , input_types_{engine_->input_data_types()}
   , output_types_{engine_->output_data_types()}
-  , compiler_{self.name()}
+  , routes_{self.name()}
+  , permits_{report->pool_size()}
 {
-    // nop
+    emitter_guard_->service = this;
+
+    auto reporting = std::vector<const ReportingEngine*>{};
+    for (const auto* engine : engines_) {
+        if (const auto* r = dynamic_cast<const ReportingEngine*>(engine)) {
+            reporting.push_back(r);
+        }
+    }
+    report_->set_engines(std::move(reporting));
 }
 
 
-ServiceEngine::~ServiceEngine() = default;
+ServiceEngine::~ServiceEngine()
+{
+    // the engines are destroyed after the service
+    report_->set_engines({});
+
+    // waits for a running emitter, the next ones will do nothing
+    std::unique_lock<std::mutex> lock{emitter_guard_->mutex};
+    emitter_guard_->service = nullptr;
+}
+
+
+class ServiceEngine::RouteEmitter : public Emitter
+{
+public:
+    RouteEmitter(std::shared_ptr<EmitterGuard> guard,
+                 const msg::proto::Meta& in_meta,
+                 std::shared_ptr<const composition::Route> route)
+      : guard_{std::move(guard)}
+      , in_meta_{in_meta}
+      , route_{std::move(route)}
+    {
+        // nop
+    }
+
+    void emit(EngineData& output) override
+    {
+        std::unique_lock<std::mutex> lock{guard_->mutex};
+        if (guard_->service != nullptr) {
+            guard_->service->emit_result(output, in_meta_, *route_);
+        }
+    }
+
+private:
+    std::shared_ptr<EmitterGuard> guard_;
+    msg::proto::Meta in_meta_;
+    std::shared_ptr<const composition::Route> route_;
+};
 
 
 void ServiceEngine::setup(msg::Message& msg)
@@ -99,41 +224,149 @@ void ServiceEngine::configure(msg::Message& msg)
     if (msg.has_replyto()) {
         send_response(output_data, msg.replyto());
     } else {
-        report_problem(output_data);
+        auto output_msg = OutputMessage{};
+        report_problem(output_data, output_msg);
     }
 }
 
 
 void ServiceEngine::execute(msg::Message& msg)
 {
+    // wait for the fused requests running in the threads of other services
+    permits_.acquire();
+    auto permit = Permit{permits_};
+
     report_->add_n_requests();
     config_->add_request();
 
     auto input_data = get_engine_data(msg);
-    parse_composition(input_data);
-    auto output_data = execute_engine(input_data);
-
-    update_metadata(input_data, output_data);
 
     if (msg.has_replyto()) {
+        auto output_data = execute_engine(input_data);
+        if (!output_data.has_data()) {
+            output_data.set_data(type::STRING.mime_type(), "done");
+        }
+        update_metadata(input_data, output_data);
         send_response(output_data, msg.replyto());
+    } else {
+        execute_composition(input_data);
+    }
+
+    if (accessor_.is_deserialized(input_data)) {
+        report_->add_input_reads();
+    } else {
+        report_->add_input_skips();
+    }
+}
+
+
+void ServiceEngine::execute(EngineData& input)
+{
+    report_->add_n_requests();
+    report_->add_shm_reads();
+    config_->add_request();
+
+    execute_composition(input);
+}
+
+
+auto ServiceEngine::accepts(const EngineData& input) const -> bool
+{
+    // the workers of this service are the only ones that can use
+    // the engine instances when there is one per worker
+    if (engines_.size() > 1 || is_active(this)) {
+        return false;
+    }
+    return accessor_.find_type(input, input_types_) != nullptr;
+}
+
+
+auto ServiceEngine::try_execute(EngineData& input) -> bool
+{
+    // a fused request runs in the thread of the upstream service,
+    // and it is queued instead when the pool workers use all permits
+    if (!accepts(input) || !permits_.try_acquire()) {
+        return false;
+    }
+    auto permit = Permit{permits_};
+    execute(input);
+    return true;
+}
+
+
+void ServiceEngine::execute_composition(EngineData& input)
+{
+    auto active = ActiveService{this};
+
+    auto route = get_route(input);
+    if (streaming_) {
+        auto* engine = dynamic_cast<StreamingEngine*>(worker_engine());
+        engine->set_emitter(make_emitter(input, route));
+    }
+    auto output_data = execute_engine(input);
+    if (!output_data.has_data()) {
+        // the results were emitted by the engine
         return;
     }
 
-    report_problem(output_data);
+    update_metadata(input, output_data);
+    publish_result(output_data, *route);
+}
+
+
+void ServiceEngine::publish_result(EngineData& output_data,
+                                   const composition::Route& route)
+{
+    auto output_msg = OutputMessage{};
+    report_problem(output_data, output_msg);
     if (output_data.status() == EngineStatus::ERROR) {
         report_->add_n_failures();
+        recycle_output(output_msg);
         return;
     }
-    report_result(output_data);
-    send_result(output_data, get_links(input_data, output_data));
+    report_result(output_data, output_msg);
+    send_result(output_data, output_msg, route);
+    recycle_output(output_msg);
+}
+
+
+void ServiceEngine::emit_result(EngineData& output,
+                                const msg::proto::Meta& in_meta,
+                                const composition::Route& route)
+{
+    auto active = ActiveService{this};
+
+    update_metadata(in_meta, output);
+    publish_result(output, route);
+}
+
+
+auto ServiceEngine::make_emitter(const EngineData& input,
+                                 std::shared_ptr<const composition::Route> route)
+    -> std::shared_ptr<Emitter>
+{
+    return std::make_shared<RouteEmitter>(emitter_guard_,
+                                          *accessor_.view_meta(input),
+                                          std::move(route));
 }
 
 
 auto ServiceEngine::configure_engine(EngineData& input) -> EngineData
 {
     try {
+        // broadcast the configuration to all instances,
+        // and keep the first error reported by any of them
+        std::unique_lock<std::shared_mutex> lock{engines_mutex_};
         auto output_data = engine_->configure(input);
+        for (auto it = std::next(engines_.begin()); it != engines_.end(); ++it) {
+            auto instance_output = (*it)->configure(input);
+            if (instance_output.status() == EngineStatus::ERROR &&
+                    output_data.status() != EngineStatus::ERROR) {
+                output_data = std::move(instance_output);
+            }
+        }
+        lock.unlock();
+
         if (!output_data.has_data()) {
             output_data.set_data(type::STRING.mime_type(), "done");
         }
@@ -147,14 +380,19 @@ auto ServiceEngine::configure_engine(EngineData& input) -> EngineData
 auto ServiceEngine::execute_engine(EngineData& input) -> EngineData
 {
     try {
+        auto lock = std::shared_lock<std::shared_mutex>{engines_mutex_, std::defer_lock};
+        if (engines_.size() > 1) {
+            lock.lock();
+        }
+        auto* engine = worker_engine();
         auto t0 = std::chrono::high_resolution_clock::now();
-        auto output_data = engine_->execute(input);
+        auto output_data = engine->execute(input);
         auto t1 = std::chrono::high_resolution_clock::now();
 
         if (!output_data.has_data()) {
             if (output_data.status() == EngineStatus::ERROR) {
                 output_data.set_data(type::STRING.mime_type(), "udf");
-            } else {
+            } else if (!streaming_) {
                 throw std::runtime_error{"no output data"};
             }
         }
@@ -170,6 +408,18 @@ auto ServiceEngine::execute_engine(EngineData& input) -> EngineData
 }
 
 
+auto ServiceEngine::worker_engine() -> Engine*
+{
+    if (engines_.size() > 1) {
+        auto id = util::current_worker_id();
+        if (id < engines_.size()) {
+            return engines_[id];
+        }
+    }
+    return engine_;
+}
+
+
 auto ServiceEngine::get_engine_data(msg::Message& msg) -> EngineData
 {
     report_->add_bytes_recv(static_cast<std::int64_t>(msg.data().size()));
@@ -180,52 +430,79 @@ auto ServiceEngine::get_engine_data(msg::Message& msg) -> EngineData
 auto ServiceEngine::put_engine_data(const EngineData& output,
                                     const msg::Topic& topic) -> msg::Message
 {
-    auto msg = accessor_.serialize(output, topic, output_types_);
+    auto msg = serialize(output, topic);
     report_->add_bytes_sent(static_cast<std::int64_t>(msg.data().size()));
     return msg;
 }
 
 
 auto ServiceEngine::put_engine_data(const EngineData& output,
-                                    const std::string& receiver) -> msg::Message
+                                    const msg::Topic& topic,
+                                    OutputMessage& cache) -> msg::Message&
 {
-    auto topic = msg::Topic::raw(receiver);
-    auto msg = accessor_.serialize(output, topic, output_types_);
-    report_->add_bytes_sent(static_cast<std::int64_t>(msg.data().size()));
+    if (cache) {
+        cache->set_topic(topic);
+    } else {
+        cache.emplace(serialize(output, topic));
+    }
+    return *cache;
+}
+
+
+auto ServiceEngine::serialize(const EngineData& output,
+                              const msg::Topic& topic) -> msg::Message
+{
+    auto reused = accessor_.has_bytes(output);
+    auto msg = accessor_.serialize(output, topic, output_types_, std::move(output_buffer));
+    if (reused) {
+        report_->add_output_reuses();
+    } else {
+        report_->add_output_writes();
+    }
     return msg;
 }
 
 
 void ServiceEngine::update_metadata(const EngineData& input, EngineData& output)
 {
-    const auto* in_meta = accessor_.view_meta(input);
+    update_metadata(*accessor_.view_meta(input), output);
+}
+
+
+void ServiceEngine::update_metadata(const msg::proto::Meta& in_meta, EngineData& output)
+{
     auto* out_meta = accessor_.view_meta(output);
 
     out_meta->set_author(name());
     out_meta->set_version(engine_->version());
 
     if (!out_meta->has_communicationid()) {
-        out_meta->set_communicationid(in_meta->communicationid());
+        out_meta->set_communicationid(in_meta.communicationid());
     }
-    out_meta->set_composition(in_meta->composition());
-    out_meta->set_action(in_meta->action());
+    out_meta->set_composition(in_meta.composition());
+    out_meta->set_action(in_meta.action());
 }
 
 
-void ServiceEngine::parse_composition(const EngineData& input)
+auto ServiceEngine::get_route(const EngineData& input)
+    -> std::shared_ptr<const composition::Route>
 {
-    const auto& current_composition = input.composition();
-    if (current_composition != prev_composition_) {
-        compiler_.compile(current_composition);
-        prev_composition_ = current_composition;
-    }
+    return routes_.get(input.composition());
 }
 
 
-auto ServiceEngine::get_links(const EngineData& /*input*/,
-                              const EngineData& /*output*/) -> std::set<std::string>
+auto ServiceEngine::get_local_service(const composition::Link& link,
+                                      const EngineData& output)
+    -> std::shared_ptr<Service>
 {
-    return compiler_.outputs();
+    if (registry_ == nullptr) {
+        return nullptr;
+    }
+    auto service = registry_->find(link.name);
+    if (service && service->accepts(output)) {
+        return service;
+    }
+    return nullptr;
 }
 
 
@@ -238,49 +515,93 @@ void ServiceEngine::send_response(EngineData& output, const msg::Topic& topic)
 
 
 void ServiceEngine::send_result(EngineData& output,
-                                const std::set<std::string>& links)
+                                OutputMessage& output_msg,
+                                const composition::Route& route)
+{
+    // the output is copied for every co-located service but the last one,
+    // which runs at the end of the route and takes the output itself
+    auto last_service = std::shared_ptr<Service>{};
+    const composition::Link* last_link = nullptr;
+    for (const auto& link : route) {
+        auto service = get_local_service(link, output);
+        if (!service) {
+            send_link(link, output, output_msg);
+            continue;
+        }
+        if (last_service) {
+            auto input = output;
+            send_local(*last_service, *last_link, input, output_msg);
+        }
+        last_service = std::move(service);
+        last_link = &link;
+    }
+    if (last_service) {
+        send_local(*last_service, *last_link, output, output_msg);
+    }
+}
+
+
+void ServiceEngine::send_local(Service& service,
+                               const composition::Link& link,
+                               EngineData& output,
+                               OutputMessage& output_msg)
 {
-    for (auto&& ss : links) {
-        auto host = util::get_dpe_host(ss);
-        auto port = util::get_dpe_port(ss);
-        auto addr = msg::ProxyAddress{std::string{host}, port};
-        auto con = connect(addr);
-        auto msg = put_engine_data(output, ss);
-        publish(con, msg);
+    if (service.try_execute(output)) {
+        report_->add_shm_writes();
+        return;
     }
+    // all workers of the service are busy, queue the output as usual
+    send_link(link, output, output_msg);
+}
+
+
+void ServiceEngine::send_link(const composition::Link& link,
+                              EngineData& output,
+                              OutputMessage& output_msg)
+{
+    auto con = connect(link.address);
+    auto& msg = put_engine_data(output, link.topic, output_msg);
+    // only when enabled for the DPE, older C++ DPEs cannot read it
+    msg.set_compact_meta(report_->compact_meta() && link.cpp_lang);
+    report_->add_bytes_sent(static_cast<std::int64_t>(msg.data().size()));
+    publish(con, msg);
 }
 
 
-void ServiceEngine::report_problem(EngineData& output)
+void ServiceEngine::report_problem(EngineData& output, OutputMessage& output_msg)
 {
     auto status = output.status();
     if (status == EngineStatus::ERROR) {
-        report(constants::error, output);
+        report(constants::error, output, output_msg);
     } else if (status == EngineStatus::WARNING) {
-        report(constants::warning, output);
+        report(constants::warning, output, output_msg);
     }
 }
 
 
-void ServiceEngine::report_result(EngineData& output)
+void ServiceEngine::report_result(EngineData& output, OutputMessage& output_msg)
 {
     if (config_->data_count() == config_->data_count_threshold()) {
-        report(constants::data, output);
+        report(constants::data, output, output_msg);
         config_->reset_data_count();
     }
 
     if (config_->done_count() == config_->done_count_threshold()) {
         auto done_output = build_done_data(accessor_, output);
-        report(constants::done, done_output);
+        auto done_msg = OutputMessage{};
+        report(constants::done, done_output, done_msg);
         config_->reset_done_count();
     }
 }
 
 
-void ServiceEngine::report(std::string_view topic_prefix, EngineData& output)
+void ServiceEngine::report(std::string_view topic_prefix,
+                           EngineData& output,
+                           OutputMessage& output_msg)
 {
     auto topic = msg::Topic::raw(std::string{topic_prefix} + ":" + name());
-    auto msg = accessor_.serialize(output, topic, output_types_);
+    auto& msg = put_engine_data(output, topic, output_msg);
+    msg.set_compact_meta(false);
     auto con = connect(frontend().addr());
     publish(con, msg);
 }
@@ -11,15 +11,21 @@
 
 #include "base.hpp"
 #include "composition.hpp"
+#include "concurrent_utils.hpp"
 #include "engine_data_helper.hpp"
 
+#include <memory>
 #include <mutex>
-#include <set>
+#include <optional>
+#include <shared_mutex>
 #include <string>
+#include <vector>
 
 namespace clara {
 
+class Service;
 class ServiceConfig;
+class ServiceRegistry;
 class ServiceReport;
 
 class ServiceEngine : public Base
@@ -27,9 +33,10 @@ class ServiceEngine : public Base
 public:
     ServiceEngine(const Component& self,
                   const Component& frontend,
-                  Engine* engine,
+                  std::vector<Engine*> engines,
                   ServiceReport* report,
-                  ServiceConfig* config);
+                  ServiceConfig* config,
+                  ServiceRegistry* registry = nullptr);
 
     ServiceEngine(const ServiceEngine&) = delete;
 
@@ -44,50 +51,112 @@ public:
 
     void execute(msg::Message& msg);
 
+    void execute(EngineData& input);
+
+    auto accepts(const EngineData& input) const -> bool;
+
+    auto try_execute(EngineData& input) -> bool;
+
 private:
+    void execute_composition(EngineData& input);
+
+    void publish_result(EngineData& output, const composition::Route& route);
+
+    void emit_result(EngineData& output,
+                     const msg::proto::Meta& in_meta,
+                     const composition::Route& route);
+
+    auto make_emitter(const EngineData& input,
+                      std::shared_ptr<const composition::Route> route)
+        -> std::shared_ptr<Emitter>;
+
     auto configure_engine(EngineData& input) -> EngineData;
 
     auto execute_engine(EngineData& input) -> EngineData;
 
+    auto worker_engine() -> Engine*;
+
 private:
+    // the output is serialized only once, and reused for all messages
+    using OutputMessage = std::optional<msg::Message>;
+
     auto get_engine_data(msg::Message& msg) -> EngineData;
 
     auto put_engine_data(const EngineData& output,
                          const msg::Topic& topic) -> msg::Message;
 
     auto put_engine_data(const EngineData& output,
-                         const std::string& receiver) -> msg::Message;
+                         const msg::Topic& topic,
+                         OutputMessage& cache) -> msg::Message&;
+
+    auto serialize(const EngineData& output,
+                   const msg::Topic& topic) -> msg::Message;
 
     void update_metadata(const EngineData& input, EngineData& output);
 
+    void update_metadata(const msg::proto::Meta& in_meta, EngineData& output);
+
 private:
-    void parse_composition(const EngineData& input);
+    auto get_route(const EngineData& input)
+        -> std::shared_ptr<const composition::Route>;
 
-    auto get_links(const EngineData& input,
-                   const EngineData& output) -> std::set<std::string>;
+    auto get_local_service(const composition::Link& link,
+                           const EngineData& output) -> std::shared_ptr<Service>;
 
 private:
     void send_response(EngineData& output, const msg::Topic& topic);
-    void send_result(EngineData& output, const std::set<std::string>& links);
+    void send_result(EngineData& output,
+                     OutputMessage& output_msg,
+                     const composition::Route& route);
+
+    void send_local(Service& service,
+                    const composition::Link& link,
+                    EngineData& output,
+                    OutputMessage& output_msg);
+
+    void send_link(const composition::Link& link,
+                   EngineData& output,
+                   OutputMessage& output_msg);
 
-    void report_problem(EngineData& output);
-    void report_result(EngineData& output);
+    void report_problem(EngineData& output, OutputMessage& output_msg);
+    void report_result(EngineData& output, OutputMessage& output_msg);
 
-    void report(std::string_view topic_prefix, EngineData& output);
+    void report(std::string_view topic_prefix,
+                EngineData& output,
+                OutputMessage& output_msg);
 
 private:
-    std::mutex mutex_;
+    class RouteEmitter;
 
+    // the emitters given to streaming engines can outlive the service
+    struct EmitterGuard
+    {
+        std::mutex mutex;
+        ServiceEngine* service;
+    };
+
+private:
+    // with one engine per worker, a configuration is broadcast
+    // only when no worker is executing a request
+    std::shared_mutex engines_mutex_;
+
+    std::vector<Engine*> engines_;
     Engine* engine_;
+    bool streaming_;
+    std::shared_ptr<EmitterGuard> emitter_guard_;
     ServiceReport* report_;
     ServiceConfig* config_;
+    ServiceRegistry* registry_;
     EngineDataAccessor accessor_;
 
-    decltype(engine_->input_data_types()) input_types_;
-    decltype(engine_->output_data_types()) output_types_;
+    DataTypeTable input_types_;
+    DataTypeTable output_types_;
+
+    composition::RouteCache routes_;
 
-    composition::SimpleCompiler compiler_;
-    std::string prev_composition_;
+    // shared by the pool workers and the requests of other services
+    // running in their threads, so no more than pool size requests can run
+    util::Semaphore permits_;
 };
 
 } // end namespace clara
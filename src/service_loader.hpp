@@ -20,6 +20,26 @@ namespace clara {
 
 class ServiceLoader
 {
+public:
+    /**
+     * Resets an engine before destroying it, so the engine can stop
+     * its background work while it is still complete.
+     */
+    struct Deleter
+    {
+        void operator()(Engine* engine) const
+        {
+            try {
+                engine->reset();
+            } catch (const std::exception& e) {
+                std::cerr << "could not reset service: " << e.what() << std::endl;
+            }
+            delete engine;
+        }
+    };
+
+    using EnginePtr = std::unique_ptr<Engine, Deleter>;
+
 public:
     ServiceLoader(const std::string& path)
     {
@@ -33,7 +53,7 @@ public:
             throw std::runtime_error("could not load '" + fullPath + "': " + dlerror());
         }
         create_service_ = get_function<create_service_fn>("create_engine");
-        service_engine_ = create_service_();
+        service_engine_ = create();
     }
 
     ServiceLoader(ServiceLoader&& other) noexcept
@@ -66,6 +86,15 @@ public:
         return get();
     }
 
+    /**
+     * Creates a new engine instance with the factory of the loaded library.
+     * The instance must be destroyed before the loader.
+     */
+    auto create() const -> EnginePtr
+    {
+        return EnginePtr{create_service_().release()};
+    }
+
 private:
     using create_service_fn = std::unique_ptr<Engine> (*)();
 
@@ -85,7 +114,7 @@ private:
 private:
     void* handle_;
     create_service_fn create_service_;
-    std::unique_ptr<Engine> service_engine_;
+    EnginePtr service_engine_;
 };
 
 } // end namespace clara
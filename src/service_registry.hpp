@@ -0,0 +1,56 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef CLARA_SERVICE_REGISTRY_HPP
+#define CLARA_SERVICE_REGISTRY_HPP
+
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+
+namespace clara {
+
+class Service;
+
+/**
+ * The services deployed in the local DPE, indexed by their canonical name.
+ * Used to run co-located composition steps in-process.
+ */
+class ServiceRegistry
+{
+public:
+    void add(const std::string& name, const std::shared_ptr<Service>& service)
+    {
+        std::unique_lock<std::shared_mutex> lock{mutex_};
+        services_[name] = service;
+    }
+
+    void remove(const std::string& name)
+    {
+        std::unique_lock<std::shared_mutex> lock{mutex_};
+        services_.erase(name);
+    }
+
+    auto find(const std::string& name) const -> std::shared_ptr<Service>
+    {
+        std::shared_lock<std::shared_mutex> lock{mutex_};
+        auto it = services_.find(name);
+        if (it != services_.end()) {
+            return it->second.lock();
+        }
+        return nullptr;
+    }
+
+private:
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::string, std::weak_ptr<Service>> services_;
+};
+
+} // end namespace clara
+
+#endif // end of include guard: CLARA_SERVICE_REGISTRY_HPP
@@ -8,6 +8,10 @@
 
 #include "utils.hpp"
 
+#include <clara/engine.hpp>
+
+#include <algorithm>
+
 namespace clara {
 
 ServiceReport::ServiceReport(std::string_view name,
@@ -19,6 +23,7 @@ ServiceReport::ServiceReport(std::string_view name,
   , engine_{params.engine_name}
   , library_{params.engine_lib}
   , pool_size_{params.pool_size}
+  , compact_meta_{params.compact_meta}
   , author_{author}
   , version_{version}
   , description_{description}
@@ -27,4 +32,31 @@ ServiceReport::ServiceReport(std::string_view name,
     // nop
 }
 
+
+
+auto ServiceReport::engine_stats() const -> EngineStats
+{
+    std::unique_lock<std::mutex> lock{engines_mutex_};
+    auto stats = EngineStats{};
+    for (const auto* engine : engines_) {
+        for (auto& [key, value] : engine->stats()) {
+            auto it = std::find_if(stats.begin(), stats.end(),
+                                   [&key = key](const auto& s) { return s.first == key; });
+            if (it != stats.end()) {
+                it->second += value;
+            } else {
+                stats.emplace_back(std::move(key), value);
+            }
+        }
+    }
+    return stats;
+}
+
+
+void ServiceReport::set_engines(std::vector<const ReportingEngine*> engines)
+{
+    std::unique_lock<std::mutex> lock{engines_mutex_};
+    engines_ = std::move(engines);
+}
+
 }
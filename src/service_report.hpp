@@ -11,10 +11,15 @@
 
 #include <atomic>
 #include <cstdint>
+#include <mutex>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace clara {
 
+class ReportingEngine;
+
 struct ServiceParameters
 {
     std::string engine_name;
@@ -22,6 +27,8 @@ struct ServiceParameters
     std::string initial_state;
     std::string description;
     int pool_size;
+    bool engine_per_worker = false;
+    bool compact_meta = false;
 };
 
 
@@ -47,6 +54,8 @@ public:
 
     auto pool_size() const -> int { return pool_size_; };
 
+    auto compact_meta() const -> bool { return compact_meta_; };
+
     auto description() const -> std::string_view { return description_; };
 
     auto version() const -> std::string_view { return version_; };
@@ -68,6 +77,27 @@ public:
 
     auto exec_time() const -> long { return exec_time_.load(); };
 
+    auto input_reads() const -> long { return input_reads_.load(); };
+
+    auto input_skips() const -> long { return input_skips_.load(); };
+
+    auto output_writes() const -> long { return output_writes_.load(); };
+
+    auto output_reuses() const -> long { return output_reuses_.load(); };
+
+    using EngineStats = std::vector<std::pair<std::string, long>>;
+
+    /**
+     * Gets the statistics of the engines of the service, if they have any.
+     */
+    auto engine_stats() const -> EngineStats;
+
+    /**
+     * Sets the engines with statistics. They must be unset before the
+     * engines are destroyed.
+     */
+    void set_engines(std::vector<const ReportingEngine*> engines);
+
 public:
     void add_n_requests() { n_requests_.fetch_add(1); };
 
@@ -83,17 +113,29 @@ public:
 
     void add_exec_time(std::int64_t duration) { exec_time_.fetch_add(duration); };
 
+    void add_input_reads() { input_reads_.fetch_add(1); };
+
+    void add_input_skips() { input_skips_.fetch_add(1); };
+
+    void add_output_writes() { output_writes_.fetch_add(1); };
+
+    void add_output_reuses() { output_reuses_.fetch_add(1); };
+
 private:
     std::string name_;
     std::string engine_;
     std::string library_;
 
     int pool_size_;
+    bool compact_meta_;
     std::string author_;
     std::string version_;
     std::string description_;
     std::string start_time_;
 
+    mutable std::mutex engines_mutex_;
+    std::vector<const ReportingEngine*> engines_;
+
     std::atomic<std::int64_t> n_requests_{0};
     std::atomic<std::int64_t> n_failures_{0};
     std::atomic<std::int64_t> shm_reads_{0};
@@ -101,6 +143,10 @@ private:
     std::atomic<std::int64_t> bytes_recv_{0};
     std::atomic<std::int64_t> bytes_sent_{0};
     std::atomic<std::int64_t> exec_time_{0};
+    std::atomic<std::int64_t> input_reads_{0};
+    std::atomic<std::int64_t> input_skips_{0};
+    std::atomic<std::int64_t> output_writes_{0};
+    std::atomic<std::int64_t> output_reuses_{0};
 };
 
 } // end namespace clara
@@ -0,0 +1,250 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/stdlib/block_io.hpp>
+
+#include <cerrno>
+#include <cstring>
+#include <utility>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace {
+
+auto system_error(const std::string& path, const char* msg) -> clara::stdlib::BlockIOError
+{
+    return clara::stdlib::BlockIOError{path + ": " + msg + ": " + std::strerror(errno)};
+}
+
+
+auto align_down(std::uint64_t value) -> std::uint64_t
+{
+    return value & ~std::uint64_t{clara::stdlib::BlockBuffer::alignment - 1};
+}
+
+
+auto align_up(std::uint64_t value) -> std::uint64_t
+{
+    return align_down(value + clara::stdlib::BlockBuffer::alignment - 1);
+}
+
+
+// reads until the buffer is full or the end of the file,
+// returns the number of bytes read
+auto read_fully(const clara::stdlib::BlockFile& file,
+                std::uint8_t* data, std::size_t size, std::uint64_t offset) -> std::size_t
+{
+    auto done = std::size_t{0};
+    while (done < size) {
+        auto n = ::pread(file.fd(), data + done, size - done,
+                         static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw system_error(file.path(), "could not read file");
+        }
+        if (n == 0) {
+            break;
+        }
+        done += static_cast<std::size_t>(n);
+    }
+    return done;
+}
+
+
+void write_fully(const clara::stdlib::BlockFile& file,
+                 const std::uint8_t* data, std::size_t size, std::uint64_t offset)
+{
+    auto done = std::size_t{0};
+    while (done < size) {
+        auto n = ::pwrite(file.fd(), data + done, size - done,
+                          static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw system_error(file.path(), "could not write file");
+        }
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+} // end namespace
+
+
+namespace clara::stdlib {
+
+BlockBuffer::BlockBuffer(std::size_t capacity)
+  : capacity_{static_cast<std::size_t>(align_up(capacity))}
+{
+    void* memory = nullptr;
+    if (capacity_ > 0 && ::posix_memalign(&memory, alignment, capacity_) != 0) {
+        throw std::bad_alloc{};
+    }
+    memory_.reset(static_cast<std::uint8_t*>(memory));
+}
+
+
+BlockBuffer::BlockBuffer(BlockBuffer&& other) noexcept
+  : memory_{std::move(other.memory_)}
+  , capacity_{std::exchange(other.capacity_, 0)}
+  , begin_{std::exchange(other.begin_, 0)}
+  , size_{std::exchange(other.size_, 0)}
+{
+    // nop
+}
+
+
+BlockBuffer& BlockBuffer::operator=(BlockBuffer&& other) noexcept
+{
+    memory_ = std::move(other.memory_);
+    capacity_ = std::exchange(other.capacity_, 0);
+    begin_ = std::exchange(other.begin_, 0);
+    size_ = std::exchange(other.size_, 0);
+    return *this;
+}
+
+
+void BlockBuffer::resize(std::size_t size)
+{
+    if (size > capacity()) {
+        throw std::length_error{"block buffer size is larger than its capacity"};
+    }
+    size_ = size;
+}
+
+
+BlockFile::BlockFile(const std::string& path, Mode mode, bool direct)
+  : path_{path}
+{
+    auto flags = O_CLOEXEC;
+    if (mode == Mode::Read) {
+        flags |= O_RDONLY;
+    } else {
+        flags |= O_WRONLY | O_CREAT | O_TRUNC;
+    }
+#ifdef O_DIRECT
+    if (direct) {
+        fd_ = ::open(path.c_str(), flags | O_DIRECT, 0644);
+        direct_ = fd_ >= 0;
+    }
+#endif
+    if (fd_ < 0) {
+        fd_ = ::open(path.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        throw system_error(path_, "could not open file");
+    }
+}
+
+
+BlockFile::~BlockFile()
+{
+    ::close(fd_);
+}
+
+
+void BlockFile::truncate(std::uint64_t size)
+{
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0) {
+        throw system_error(path_, "could not resize file");
+    }
+}
+
+
+BlockIO::BlockIO(int threads)
+{
+    for (int i = 0; i < threads; ++i) {
+        threads_.emplace_back([this] { run(); });
+    }
+}
+
+
+BlockIO::~BlockIO()
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        stop_ = true;
+    }
+    cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+
+auto BlockIO::read(const BlockFile& file, std::uint64_t offset, std::size_t size)
+    -> std::future<BlockBuffer>
+{
+    auto result = std::make_shared<std::promise<BlockBuffer>>();
+    auto future = result->get_future();
+    submit([&file, offset, size, result] {
+        try {
+            auto first = file.direct() ? align_down(offset) : offset;
+            auto last = file.direct() ? align_up(offset + size) : offset + size;
+            auto buffer = BlockBuffer{static_cast<std::size_t>(last - first)};
+            auto read = read_fully(file, buffer.memory_.get(),
+                                   static_cast<std::size_t>(last - first), first);
+            buffer.begin_ = static_cast<std::size_t>(offset - first);
+            if (read < buffer.begin_ + size) {
+                throw BlockIOError{file.path() + ": unexpected end of file"};
+            }
+            buffer.size_ = size;
+            result->set_value(std::move(buffer));
+        } catch (...) {
+            result->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+
+auto BlockIO::write(const BlockFile& file, std::uint64_t offset, BlockBuffer buffer)
+    -> std::future<void>
+{
+    auto result = std::make_shared<std::promise<void>>();
+    auto future = result->get_future();
+    auto data = std::make_shared<BlockBuffer>(std::move(buffer));
+    submit([&file, offset, data, result] {
+        try {
+            write_fully(file, data->data(), data->size(), offset);
+            result->set_value();
+        } catch (...) {
+            result->set_exception(std::current_exception());
+        }
+    });
+    return future;
+}
+
+
+void BlockIO::submit(std::function<void()> task)
+{
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        tasks_.push_back(std::move(task));
+    }
+    cv_.notify_one();
+}
+
+
+void BlockIO::run()
+{
+    while (true) {
+        std::unique_lock<std::mutex> lock{mutex_};
+        cv_.wait(lock, [this] { return stop_ || !tasks_.empty(); });
+        if (tasks_.empty()) {
+            return;
+        }
+        auto task = std::move(tasks_.front());
+        tasks_.pop_front();
+        lock.unlock();
+        task();
+    }
+}
+
+} // end namespace clara::stdlib
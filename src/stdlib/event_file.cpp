@@ -0,0 +1,368 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/stdlib/event_file.hpp>
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <limits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+constexpr std::array<std::uint8_t, 4> file_magic = {'C', 'E', 'V', 'F'};
+constexpr std::array<std::uint8_t, 4> index_magic = {'C', 'E', 'V', 'I'};
+
+constexpr std::uint16_t file_version = 1;
+
+constexpr std::size_t header_size = 16;
+constexpr std::size_t footer_size = 24;
+constexpr std::size_t record_prefix_size = 4;
+
+
+template<typename T>
+void encode(std::uint8_t* out, T value)
+{
+    for (auto i = std::size_t{0}; i < sizeof(T); ++i) {
+        out[i] = static_cast<std::uint8_t>(value >> (8 * i));
+    }
+}
+
+
+template<typename T>
+auto decode(const std::uint8_t* in) -> T
+{
+    auto value = T{0};
+    for (auto i = std::size_t{0}; i < sizeof(T); ++i) {
+        value |= static_cast<T>(static_cast<T>(in[i]) << (8 * i));
+    }
+    return value;
+}
+
+
+auto error(const std::string& path, const char* msg) -> clara::stdlib::EventFileError
+{
+    return clara::stdlib::EventFileError{path + ": " + msg};
+}
+
+
+auto system_error(const std::string& path, const char* msg) -> clara::stdlib::EventFileError
+{
+    return clara::stdlib::EventFileError{path + ": " + msg + ": " + std::strerror(errno)};
+}
+
+} // end namespace
+
+
+namespace clara::stdlib {
+
+EventFileWriter::EventFileWriter(const std::string& path, EventFileOrder order)
+  : file_{std::fopen(path.c_str(), "wb")}
+  , path_{path}
+{
+    if (file_ == nullptr) {
+        throw system_error(path_, "could not create file");
+    }
+    try {
+        write_header(order);
+    } catch (...) {
+        std::fclose(file_);
+        throw;
+    }
+}
+
+
+EventFileWriter::EventFileWriter(const std::string& path,
+                                 EventFileOrder order,
+                                 BlockIO& io,
+                                 int depth,
+                                 bool direct)
+  : path_{path}
+  , io_{&io}
+  , depth_{static_cast<std::size_t>(std::max(depth, 1))}
+{
+    try {
+        block_file_ = std::make_unique<BlockFile>(path, BlockFile::Mode::Write, direct);
+    } catch (const BlockIOError& e) {
+        throw EventFileError{e.what()};
+    }
+    write_header(order);
+}
+
+
+EventFileWriter::~EventFileWriter()
+{
+    try {
+        close();
+    } catch (const EventFileError&) {
+        // nop
+    }
+}
+
+
+void EventFileWriter::write(const std::uint8_t* data, std::size_t size)
+{
+    if (file_ == nullptr && !block_file_) {
+        throw error(path_, "file is closed");
+    }
+    if (size > std::numeric_limits<std::uint32_t>::max()) {
+        throw error(path_, "event is too large");
+    }
+
+    auto prefix = std::array<std::uint8_t, record_prefix_size>{};
+    encode<std::uint32_t>(prefix.data(), static_cast<std::uint32_t>(size));
+
+    auto record_offset = offset_;
+    put(prefix.data(), prefix.size());
+    put(data, size);
+    index_.push_back(record_offset);
+}
+
+
+void EventFileWriter::flush()
+{
+    if (file_ != nullptr && std::fflush(file_) != 0) {
+        throw system_error(path_, "could not write file");
+    }
+}
+
+
+void EventFileWriter::close()
+{
+    if (file_ == nullptr && !block_file_) {
+        return;
+    }
+
+    auto index_offset = offset_;
+    auto entry = std::array<std::uint8_t, sizeof(std::uint64_t)>{};
+    auto footer = std::array<std::uint8_t, footer_size>{};
+    encode<std::uint64_t>(footer.data(), index_.size());
+    encode<std::uint64_t>(footer.data() + 8, index_offset);
+    std::memcpy(footer.data() + 16, index_magic.data(), index_magic.size());
+
+    try {
+        for (auto record_offset : index_) {
+            encode<std::uint64_t>(entry.data(), record_offset);
+            put(entry.data(), entry.size());
+        }
+        put(footer.data(), footer.size());
+    } catch (...) {
+        if (block_file_) {
+            try {
+                finish_blocks();
+            } catch (const EventFileError&) {
+                // nop
+            }
+        } else {
+            std::fclose(std::exchange(file_, nullptr));
+        }
+        throw;
+    }
+    if (block_file_) {
+        submit_block();
+        finish_blocks();
+        return;
+    }
+    if (std::fclose(std::exchange(file_, nullptr)) != 0) {
+        throw system_error(path_, "could not close file");
+    }
+}
+
+
+void EventFileWriter::write_header(EventFileOrder order)
+{
+    auto header = std::array<std::uint8_t, header_size>{};
+    std::memcpy(header.data(), file_magic.data(), file_magic.size());
+    encode<std::uint16_t>(header.data() + 4, file_version);
+    header[6] = static_cast<std::uint8_t>(order);
+    put(header.data(), header.size());
+}
+
+
+void EventFileWriter::put(const void* data, std::size_t size)
+{
+    if (block_file_) {
+        put_block(static_cast<const std::uint8_t*>(data), size);
+    } else if (size > 0 && std::fwrite(data, 1, size, file_) != size) {
+        throw system_error(path_, "could not write file");
+    }
+    offset_ += size;
+}
+
+
+void EventFileWriter::put_block(const std::uint8_t* data, std::size_t size)
+{
+    while (size > 0) {
+        if (block_.capacity() == 0) {
+            block_ = BlockBuffer{block_size};
+        }
+        auto used = block_.size();
+        auto n = std::min(size, block_size - used);
+        std::memcpy(block_.data() + used, data, n);
+        block_.resize(used + n);
+        data += n;
+        size -= n;
+        if (block_.size() == block_size) {
+            submit_block();
+        }
+    }
+}
+
+
+void EventFileWriter::submit_block()
+{
+    auto used = block_.size();
+    if (used == 0) {
+        return;
+    }
+    if (block_file_->direct()) {
+        // the last block is padded, and the padding removed on close
+        auto padded = (used + BlockBuffer::alignment - 1) & ~(BlockBuffer::alignment - 1);
+        std::memset(block_.data() + used, 0, padded - used);
+        block_.resize(padded);
+    }
+    writes_.push_back(io_->write(*block_file_, block_offset_, std::move(block_)));
+    block_offset_ += used;
+    block_ = BlockBuffer{};
+
+    if (writes_.size() > depth_) {
+        auto write = std::move(writes_.front());
+        writes_.pop_front();
+        try {
+            write.get();
+        } catch (const BlockIOError& e) {
+            throw EventFileError{e.what()};
+        }
+    }
+}
+
+
+void EventFileWriter::finish_blocks()
+{
+    // all the writes must end before the file is closed
+    auto error = std::string{};
+    for (auto& write : writes_) {
+        try {
+            write.get();
+        } catch (const BlockIOError& e) {
+            if (error.empty()) {
+                error = e.what();
+            }
+        }
+    }
+    writes_.clear();
+    try {
+        if (error.empty() && block_file_->direct()) {
+            block_file_->truncate(offset_);
+        }
+    } catch (const BlockIOError& e) {
+        error = e.what();
+    }
+    block_file_.reset();
+    if (!error.empty()) {
+        throw EventFileError{error};
+    }
+}
+
+
+EventFileReader::EventFileReader(const std::string& path)
+  : path_{path}
+{
+    auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        throw system_error(path_, "could not open file");
+    }
+
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        auto e = system_error(path_, "could not open file");
+        ::close(fd);
+        throw e;
+    }
+    size_ = static_cast<std::size_t>(st.st_size);
+    if (size_ < header_size + footer_size) {
+        ::close(fd);
+        throw error(path_, "not an event file");
+    }
+
+    auto* addr = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+        throw system_error(path_, "could not map file");
+    }
+    data_ = static_cast<const std::uint8_t*>(addr);
+
+    // the mapping must be released if the file is not valid
+    auto check = [this](bool valid, const char* msg) {
+        if (!valid) {
+            ::munmap(const_cast<std::uint8_t*>(data_), size_);
+            throw error(path_, msg);
+        }
+    };
+
+    check(std::memcmp(data_, file_magic.data(), file_magic.size()) == 0,
+          "not an event file");
+    check(decode<std::uint16_t>(data_ + 4) == file_version,
+          "unsupported event file version");
+    check(data_[6] <= static_cast<std::uint8_t>(EventFileOrder::Big),
+          "invalid byte order");
+    order_ = static_cast<EventFileOrder>(data_[6]);
+
+    const auto* footer = data_ + size_ - footer_size;
+    check(std::memcmp(footer + 16, index_magic.data(), index_magic.size()) == 0,
+          "missing index, the file was not closed");
+
+    auto count = decode<std::uint64_t>(footer);
+    auto index_offset = decode<std::uint64_t>(footer + 8);
+    auto index_end = size_ - footer_size;
+    check(index_offset >= header_size && index_offset <= index_end
+              && count == (index_end - index_offset) / sizeof(std::uint64_t)
+              && (index_end - index_offset) % sizeof(std::uint64_t) == 0,
+          "corrupted index");
+
+    count_ = static_cast<std::size_t>(count);
+    index_offset_ = static_cast<std::size_t>(index_offset);
+}
+
+
+EventFileReader::~EventFileReader()
+{
+    ::munmap(const_cast<std::uint8_t*>(data_), size_);
+}
+
+
+auto EventFileReader::event(std::size_t index) const -> Event
+{
+    auto record = locate(index);
+    return {data_ + record.offset, record.size};
+}
+
+
+auto EventFileReader::locate(std::size_t index) const -> Record
+{
+    if (index >= count_) {
+        throw error(path_, "event index out of range");
+    }
+
+    auto offset = decode<std::uint64_t>(data_ + index_offset_ + index * sizeof(std::uint64_t));
+    if (offset < header_size || offset > index_offset_ - record_prefix_size) {
+        throw error(path_, "corrupted event offset");
+    }
+    auto size = decode<std::uint32_t>(data_ + offset);
+    if (size > index_offset_ - offset - record_prefix_size) {
+        throw error(path_, "corrupted event size");
+    }
+    return {offset + record_prefix_size, size};
+}
+
+} // end namespace clara::stdlib
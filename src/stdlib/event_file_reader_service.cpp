@@ -0,0 +1,259 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/stdlib/event_file_reader_service.hpp>
+
+#include <clara/stdlib/json_utils.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <limits>
+
+#include <glob.h>
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+constexpr auto conf_files = "files"sv;
+constexpr auto conf_zero_copy = "zero_copy"sv;
+constexpr auto conf_io_depth = "io_depth"sv;
+constexpr auto manifest_ext = ".manifest"sv;
+
+
+auto ends_with(const std::string& str, std::string_view suffix) -> bool
+{
+    return str.size() >= suffix.size()
+        && str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+
+auto glob_files(const std::string& pattern) -> std::vector<std::string>
+{
+    auto result = glob_t{};
+    auto status = ::glob(pattern.c_str(), 0, nullptr, &result);
+    auto files = std::vector<std::string>{};
+    if (status == 0) {
+        files.assign(result.gl_pathv, result.gl_pathv + result.gl_pathc);
+    }
+    ::globfree(&result);
+    if (status != 0 && status != GLOB_NOMATCH) {
+        throw std::runtime_error{pattern + ": could not expand pattern"};
+    }
+    return files;
+}
+
+
+// the manifest has the names of the files relative to its directory
+auto manifest_files(const std::string& manifest) -> std::vector<std::string>
+{
+    auto in = std::ifstream{manifest};
+    if (!in) {
+        throw std::runtime_error{manifest + ": could not open manifest"};
+    }
+    auto text = std::string{std::istreambuf_iterator<char>{in}, {}};
+    auto data = clara::stdlib::parse_json(text);
+
+    auto dir = manifest.substr(0, manifest.rfind('/') + 1);
+    auto files = std::vector<std::string>{};
+    for (const auto& item : clara::stdlib::get_array(data, conf_files).array_items()) {
+        files.push_back(dir + clara::stdlib::get_string(item, "file"));
+    }
+    return files;
+}
+
+
+auto input_files(const std::string& file, const json11::Json& opts)
+    -> std::vector<std::string>
+{
+    if (clara::stdlib::has_key(opts, conf_files)) {
+        auto files = std::vector<std::string>{};
+        for (const auto& item : clara::stdlib::get_array(opts, conf_files).array_items()) {
+            files.push_back(item.string_value());
+        }
+        return files;
+    }
+    if (file.find_first_of("*?[") != std::string::npos) {
+        return glob_files(file);
+    }
+    if (ends_with(file, manifest_ext)) {
+        return manifest_files(file);
+    }
+    return {file};
+}
+
+} // end namespace
+
+
+namespace clara::stdlib {
+
+EventFileReaderService::EventFileReaderService(const EngineDataType& data_type)
+  : data_type_{data_type}
+{
+    // nop
+}
+
+
+EventFileReaderService::~EventFileReaderService()
+{
+    reset();
+}
+
+
+auto EventFileReaderService::name() const -> std::string
+{
+    return "EventFileReader";
+}
+
+
+auto EventFileReaderService::author() const -> std::string
+{
+    return "Clara";
+}
+
+
+auto EventFileReaderService::description() const -> std::string
+{
+    return "Reads events from indexed event files";
+}
+
+
+auto EventFileReaderService::version() const -> std::string
+{
+    return "1.0";
+}
+
+
+void EventFileReaderService::open_file(const std::string& file,
+                                       const json11::Json& opts)
+{
+    auto zero_copy = opts[conf_zero_copy].bool_value();
+    if (zero_copy && data_type_ != type::BYTES.mime_type()) {
+        throw EventReaderError{"zero copy requires " + type::BYTES.mime_type() + " events"};
+    }
+    if (zero_copy && opts[conf_io_depth].int_value() > 0) {
+        // the block reads are copies of the files, there is nothing to view
+        throw EventReaderError{"zero copy cannot be used with io_depth"};
+    }
+
+    auto readers = std::vector<std::shared_ptr<EventFileReader>>{};
+    auto first_events = std::vector<std::size_t>{};
+    auto event_count = std::size_t{0};
+    try {
+        for (const auto& path : input_files(file, opts)) {
+            auto reader = std::make_shared<EventFileReader>(path);
+            if (!readers.empty() && reader->order() != readers.front()->order()) {
+                throw EventReaderError{path + ": different byte order"};
+            }
+            first_events.push_back(event_count);
+            event_count += reader->count();
+            readers.push_back(std::move(reader));
+        }
+    } catch (const EventReaderError&) {
+        throw;
+    } catch (const std::exception& e) {
+        throw EventReaderError{e.what()};
+    }
+
+    if (readers.empty()) {
+        throw EventReaderError{file + ": no input files"};
+    }
+    if (event_count > static_cast<std::size_t>(std::numeric_limits<int>::max())) {
+        throw EventReaderError{file + ": too many events"};
+    }
+
+    readers_ = std::move(readers);
+    first_events_ = std::move(first_events);
+    event_count_ = event_count;
+    zero_copy_ = zero_copy;
+}
+
+
+void EventFileReaderService::close_file()
+{
+    readers_.clear();
+    first_events_.clear();
+    event_count_ = 0;
+}
+
+
+auto EventFileReaderService::has_file() -> bool
+{
+    return !readers_.empty();
+}
+
+
+auto EventFileReaderService::read_event(int event_number) -> std::any
+{
+    auto [reader, index] = find_event(event_number);
+    try {
+        auto event = reader->event(index);
+        if (zero_copy_) {
+            return BytesView{event.data, event.size, reader};
+        }
+        return data_type_.serializer()->read(
+                Serializer::Buffer(event.data, event.data + event.size));
+    } catch (const EventFileError& e) {
+        throw EventReaderError{e.what()};
+    }
+}
+
+
+auto EventFileReaderService::locate_event(int event_number) -> std::optional<EventRecord>
+{
+    auto [reader, index] = find_event(event_number);
+    try {
+        auto record = reader->locate(index);
+        return EventRecord{reader->path(), record.offset, record.size};
+    } catch (const EventFileError& e) {
+        throw EventReaderError{e.what()};
+    }
+}
+
+
+auto EventFileReaderService::decode_event(int /*event_number*/,
+                                          const std::uint8_t* data,
+                                          std::size_t size) -> std::any
+{
+    return data_type_.serializer()->read(Serializer::Buffer(data, data + size));
+}
+
+
+auto EventFileReaderService::find_event(int event_number)
+    -> std::pair<std::shared_ptr<EventFileReader>, std::size_t>
+{
+    auto index = static_cast<std::size_t>(event_number);
+    if (event_number < 0 || index >= event_count_) {
+        throw EventReaderError{"event index out of range"};
+    }
+
+    // the last file that starts before the event
+    auto it = std::upper_bound(first_events_.begin(), first_events_.end(), index);
+    auto file = static_cast<std::size_t>(std::distance(first_events_.begin(), it) - 1);
+    return {readers_[file], index - first_events_[file]};
+}
+
+
+auto EventFileReaderService::read_event_count() -> int
+{
+    return static_cast<int>(event_count_);
+}
+
+
+auto EventFileReaderService::read_byte_order() -> Endian
+{
+    return readers_.front()->order() == EventFileOrder::Big ? Endian::Big
+                                                            : Endian::Little;
+}
+
+
+auto EventFileReaderService::get_data_type() const -> const EngineDataType&
+{
+    return data_type_;
+}
+
+} // end namespace clara::stdlib
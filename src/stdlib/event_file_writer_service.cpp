@@ -0,0 +1,292 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/stdlib/event_file_writer_service.hpp>
+
+#include <clara/stdlib/json_utils.hpp>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <utility>
+
+using namespace std::literals::string_view_literals;
+
+namespace {
+
+constexpr auto conf_shards = "shards"sv;
+constexpr auto conf_rotate_events = "rotate_events"sv;
+constexpr auto conf_rotate_mb = "rotate_mb"sv;
+
+constexpr auto max_shards = 64;
+constexpr auto max_int = std::numeric_limits<int>::max();
+
+
+auto get_option(const json11::Json& opts, std::string_view key,
+                int def_val, int min_val, int max_val) -> int
+{
+    if (!clara::stdlib::has_key(opts, key)) {
+        return def_val;
+    }
+    auto value = clara::stdlib::get_int(opts, key);
+    if (value < min_val || value > max_val) {
+        throw std::invalid_argument{"invalid value for \"" + std::string{key}
+                                    + "\": " + std::to_string(value)};
+    }
+    return value;
+}
+
+
+// out/events.cevf -> out/events_001.cevf
+auto numbered_name(const std::string& file, int number) -> std::string
+{
+    auto dir = file.rfind('/');
+    auto ext = file.rfind('.');
+    if (ext == std::string::npos || (dir != std::string::npos && ext < dir)) {
+        ext = file.size();
+    }
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_%03d", number);
+    return file.substr(0, ext) + suffix + file.substr(ext);
+}
+
+
+auto base_name(const std::string& file) -> std::string
+{
+    auto dir = file.rfind('/');
+    return dir == std::string::npos ? file : file.substr(dir + 1);
+}
+
+} // end namespace
+
+
+namespace clara::stdlib {
+
+struct EventFileWriterService::Shard
+{
+    std::mutex mutex;
+    std::unique_ptr<EventFileWriter> writer;
+};
+
+
+EventFileWriterService::EventFileWriterService(const EngineDataType& data_type)
+  : data_type_{data_type}
+{
+    // nop
+}
+
+
+EventFileWriterService::~EventFileWriterService()
+{
+    reset();
+}
+
+
+auto EventFileWriterService::name() const -> std::string
+{
+    return "EventFileWriter";
+}
+
+
+auto EventFileWriterService::author() const -> std::string
+{
+    return "Clara";
+}
+
+
+auto EventFileWriterService::description() const -> std::string
+{
+    return "Writes events into indexed event files";
+}
+
+
+auto EventFileWriterService::version() const -> std::string
+{
+    return "1.0";
+}
+
+
+void EventFileWriterService::open_file(const std::string& file,
+                                       const json11::Json& opts)
+{
+    auto n_shards = 1;
+    try {
+        n_shards = get_option(opts, conf_shards, 1, 1, max_shards);
+        rotate_events_ = get_option(opts, conf_rotate_events, 0, 0, max_int);
+        rotate_bytes_ = static_cast<std::size_t>(
+                get_option(opts, conf_rotate_mb, 0, 0, max_int)) << 20U;
+    } catch (const std::exception& e) {
+        throw EventWriterError{e.what()};
+    }
+
+    file_ = file;
+    order_ = parse_byte_order(opts) == Endian::Big ? EventFileOrder::Big
+                                                   : EventFileOrder::Little;
+    split_ = n_shards > 1 || rotate_events_ > 0 || rotate_bytes_ > 0;
+    file_count_ = 0;
+    files_.clear();
+
+    try {
+        for (int i = 0; i < n_shards; ++i) {
+            auto shard = std::make_unique<Shard>();
+            shard->writer = next_file();
+            shards_.push_back(std::move(shard));
+        }
+    } catch (const EventFileError& e) {
+        shards_.clear();
+        throw EventWriterError{e.what()};
+    }
+}
+
+
+void EventFileWriterService::close_file()
+{
+    for (auto& shard : shards_) {
+        try {
+            finish_file(*shard->writer);
+        } catch (const EventFileError& e) {
+            std::cerr << name() << " " << e.what() << std::endl;
+        }
+    }
+    shards_.clear();
+    if (split_) {
+        write_manifest();
+    }
+}
+
+
+auto EventFileWriterService::has_file() -> bool
+{
+    return !shards_.empty();
+}
+
+
+void EventFileWriterService::write_event(const std::any& event)
+{
+    // serialized before locking the file
+    thread_local auto buffer = Serializer::Buffer{};
+    data_type_.serializer()->write_into(event, buffer);
+
+    auto index = next_shard_.fetch_add(1, std::memory_order_relaxed) % shards_.size();
+    auto& shard = *shards_[index];
+
+    std::unique_lock<std::mutex> lock{shard.mutex};
+    write_buffer(shard, buffer);
+}
+
+
+void EventFileWriterService::write_events(const std::vector<std::any>& events)
+{
+    thread_local auto buffer = Serializer::Buffer{};
+
+    // the events keep the round robin order of single writes,
+    // but every shard is locked and flushed once for the whole batch
+    auto n_shards = shards_.size();
+    auto first = next_shard_.fetch_add(events.size(), std::memory_order_relaxed);
+    for (auto index = std::size_t{0}; index < std::min(n_shards, events.size()); ++index) {
+        auto& shard = *shards_[(first + index) % n_shards];
+        std::unique_lock<std::mutex> lock{shard.mutex};
+        for (auto i = index; i < events.size(); i += n_shards) {
+            data_type_.serializer()->write_into(events[i], buffer);
+            write_buffer(shard, buffer);
+        }
+        try {
+            shard.writer->flush();
+        } catch (const EventFileError& e) {
+            throw EventWriterError{e.what()};
+        }
+    }
+}
+
+
+// the lock of the shard must be held
+void EventFileWriterService::write_buffer(Shard& shard, const Serializer::Buffer& buffer)
+{
+    try {
+        shard.writer->write(buffer);
+    } catch (const EventFileError& e) {
+        throw EventWriterError{e.what()};
+    }
+
+    const auto& writer = *shard.writer;
+    if ((rotate_events_ > 0 && writer.count() >= rotate_events_)
+            || (rotate_bytes_ > 0 && writer.size() >= rotate_bytes_)) {
+        // the shard keeps an open file if the rotation fails
+        try {
+            auto full = next_file();
+            std::swap(shard.writer, full);
+            finish_file(*full);
+        } catch (const EventFileError& e) {
+            throw EventWriterError{std::string{"could not rotate file: "} + e.what()};
+        }
+    }
+}
+
+
+auto EventFileWriterService::concurrent_writes() const -> bool
+{
+    return true;
+}
+
+
+auto EventFileWriterService::get_data_type() const -> const EngineDataType&
+{
+    return data_type_;
+}
+
+
+auto EventFileWriterService::next_file() -> std::unique_ptr<EventFileWriter>
+{
+    auto path = file_;
+    if (split_) {
+        std::unique_lock<std::mutex> lock{files_mutex_};
+        path = numbered_name(file_, file_count_++);
+    }
+    auto blocks = block_writes();
+    if (blocks.io != nullptr) {
+        return std::make_unique<EventFileWriter>(path, order_, *blocks.io,
+                                                 blocks.depth, blocks.direct);
+    }
+    return std::make_unique<EventFileWriter>(path, order_);
+}
+
+
+void EventFileWriterService::finish_file(EventFileWriter& writer)
+{
+    writer.close();
+    std::unique_lock<std::mutex> lock{files_mutex_};
+    files_.emplace_back(base_name(writer.path()), writer.count());
+}
+
+
+void EventFileWriterService::write_manifest()
+{
+    auto files = json11::Json::array{};
+    auto total = std::size_t{0};
+    for (const auto& [path, count] : files_) {
+        files.push_back(json11::Json::object{
+            {"file", path},
+            {"events", static_cast<double>(count)},
+        });
+        total += count;
+    }
+    auto manifest = json11::Json{json11::Json::object{
+        {"files", files},
+        {"events", static_cast<double>(total)},
+    }};
+
+    auto path = file_ + ".manifest";
+    auto out = std::ofstream{path};
+    out << manifest.dump() << '\n';
+    if (!out) {
+        std::cerr << name() << " could not write manifest " << path << std::endl;
+    }
+}
+
+} // end namespace clara::stdlib
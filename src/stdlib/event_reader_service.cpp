@@ -6,13 +6,26 @@
 
 #include <clara/stdlib/event_reader_service.hpp>
 
+#include <clara/stdlib/block_io.hpp>
 #include <clara/stdlib/json_utils.hpp>
 
 #include "service_utils.hpp"
 
+#include <algorithm>
+#include <charconv>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <future>
 #include <iostream>
+#include <map>
 #include <mutex>
+#include <optional>
 #include <sstream>
+#include <thread>
+#include <utility>
+#include <vector>
 
 
 using namespace std::literals::string_view_literals;
@@ -27,11 +40,25 @@ constexpr auto conf_action_close = "close"sv;
 
 constexpr auto conf_events_skip = "skip"sv;
 constexpr auto conf_events_max = "max"sv;
+constexpr auto conf_prefetch = "prefetch"sv;
+constexpr auto conf_stream = "stream"sv;
+constexpr auto conf_io_depth = "io_depth"sv;
+constexpr auto conf_direct = "direct"sv;
+
+constexpr auto max_prefetch = 1024;
+constexpr auto max_io_depth = 1024;
+constexpr auto max_io_threads = 16;
+constexpr auto max_stream = 1024;
 
 constexpr auto request_next = "next"sv;
 constexpr auto request_next_rec = "next-rec"sv;
 constexpr auto request_order = "order"sv;
 constexpr auto request_count = "count"sv;
+constexpr auto request_next_batch = "next-batch"sv;
+constexpr auto request_next_batch_rec = "next-batch-rec"sv;
+
+constexpr auto default_batch_size = 16;
+constexpr auto max_batch_size = 1024;
 
 constexpr auto no_file = "No open file"sv;
 constexpr auto end_of_file = "End of file"sv;
@@ -39,11 +66,137 @@ constexpr auto end_of_file = "End of file"sv;
 constexpr auto eof_not_from_writer = 0;
 constexpr auto eof_waiting_rec = -1;
 
+
+struct BatchRequest
+{
+    bool from_rec;
+    int size;
+};
+
+
+// parses "next-batch[-rec][:N]"
+auto parse_batch_request(std::string_view request) -> std::optional<BatchRequest>
+{
+    auto sep = request.find(':');
+    auto name = request.substr(0, sep);
+    auto size = default_batch_size;
+    if (sep != std::string_view::npos) {
+        auto value = request.substr(sep + 1);
+        const auto* end = value.data() + value.size();
+        auto [ptr, ec] = std::from_chars(value.data(), end, size);
+        if (ec != std::errc{} || ptr != end || size < 1 || size > max_batch_size) {
+            return std::nullopt;
+        }
+    }
+    if (name == request_next_batch) {
+        return BatchRequest{false, size};
+    }
+    if (name == request_next_batch_rec) {
+        return BatchRequest{true, size};
+    }
+    return std::nullopt;
+}
+
+
+// The emitter of the request about to be executed by the current thread.
+// The service sets it right before executing a request of a composition,
+// so requests without an emitter (i.e. sync requests) never take the one
+// of an earlier request.
+thread_local std::shared_ptr<clara::Emitter> request_emitter;
+
+
+class EventBatchSerializer : public clara::Serializer
+{
+public:
+    EventBatchSerializer(const clara::EngineDataType& event_type)
+      : event_type_{event_type}
+    {
+        // nop
+    }
+
+    auto write(const std::any& data) const -> std::vector<std::uint8_t> override
+    {
+        auto buffer = std::vector<std::uint8_t>{};
+        write_into(data, buffer);
+        return buffer;
+    }
+
+    void write_into(const std::any& data, Buffer& buffer) const override
+    {
+        const auto& batch = std::any_cast<const clara::stdlib::EventBatch&>(data);
+        const auto* serializer = event_type_.serializer();
+
+        buffer.clear();
+        put(buffer, static_cast<std::uint32_t>(batch.events.size()));
+        auto event_buffer = Buffer{};
+        for (auto i = std::size_t{0}; i < batch.events.size(); ++i) {
+            serializer->write_into(batch.events[i], event_buffer);
+            put(buffer, static_cast<std::int64_t>(batch.event_ids[i]));
+            put(buffer, static_cast<std::uint32_t>(event_buffer.size()));
+            buffer.insert(buffer.end(), event_buffer.begin(), event_buffer.end());
+        }
+    }
+
+    auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
+    {
+        const auto* serializer = event_type_.serializer();
+
+        auto offset = std::size_t{0};
+        auto count = get<std::uint32_t>(buffer, offset);
+
+        auto batch = clara::stdlib::EventBatch{};
+        batch.event_ids.reserve(count);
+        batch.events.reserve(count);
+        for (auto i = std::uint32_t{0}; i < count; ++i) {
+            auto event_id = get<std::int64_t>(buffer, offset);
+            auto size = get<std::uint32_t>(buffer, offset);
+            if (size > buffer.size() - offset) {
+                throw std::invalid_argument{"truncated event batch"};
+            }
+            auto first = buffer.begin() + static_cast<std::ptrdiff_t>(offset);
+            batch.event_ids.push_back(static_cast<long>(event_id));
+            batch.events.push_back(serializer->read(Buffer(first, first + size)));
+            offset += size;
+        }
+        return batch;
+    }
+
+private:
+    template<typename T>
+    static void put(Buffer& buffer, T value)
+    {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);  // NOLINT
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(T));
+    }
+
+    template<typename T>
+    static auto get(const Buffer& buffer, std::size_t& offset) -> T
+    {
+        if (sizeof(T) > buffer.size() - offset) {
+            throw std::invalid_argument{"truncated event batch"};
+        }
+        auto value = T{};
+        std::memcpy(&value, buffer.data() + offset, sizeof(T));
+        offset += sizeof(T);
+        return value;
+    }
+
+private:
+    clara::EngineDataType event_type_;
+};
+
 } // namespace
 
 
 namespace clara::stdlib {
 
+auto make_event_batch_type(const EngineDataType& event_type) -> EngineDataType
+{
+    return {event_type.mime_type() + ";batch",
+            std::make_unique<EventBatchSerializer>(event_type)};
+}
+
+
 class EventReaderService::Impl
 {
 public:
@@ -54,25 +207,73 @@ public:
     void open_file(const json11::Json& config_data);
     void close_file(const json11::Json& config_data);
 
-    auto has_file() -> bool { return service_->has_file(); }
+    auto has_file() -> bool
+    {
+        std::unique_lock<std::mutex> io_lock{io_mutex_};
+        return service_->has_file();
+    }
     void close_file();
 
 private:
     void set_limits(const json11::Json& config_data);
+    void set_prefetch(const json11::Json& config_data);
+    void set_stream(const json11::Json& config_data);
     auto get_value(const json11::Json& config_data, std::string_view key,
                    int def_val, int min_val, int max_val) -> int;
 
 public:
-    void get_next_event(const EngineData& input, EngineData& output);
+    void get_next_event(const EngineData& input,
+                        std::shared_ptr<Emitter> emitter,
+                        EngineData& output);
+    void get_next_batch(const EngineData& input, const BatchRequest& request,
+                        EngineData& output);
     void get_file_byte_order(EngineData& output);
     void get_event_count(EngineData& output);
 
+    auto batch_type() -> const EngineDataType&;
+
 private:
     auto is_rec_request(const EngineData& input) -> bool;
     void return_next_event(EngineData& output);
+    void return_next_batch(int size, EngineData& output);
+    void return_end_of_file(bool from_rec, EngineData& output);
+    void finish_batch(long event_id);
     auto get_order(Endian endian) -> std::string;
 
+private:
+    struct PrefetchedEvent
+    {
+        std::any event;
+        std::exception_ptr error;
+    };
+
+    auto next_event(int event_id) -> PrefetchedEvent;
+
+    void start_prefetch();
+    void stop_prefetch();
+    void prefetch_events(int first_event, int last_event);
+    auto put_prefetched_event(PrefetchedEvent prefetched) -> bool;
+    auto next_prefetched_event() -> PrefetchedEvent;
+
+    // a block read in flight, or the event if it was read directly
+    struct PendingRead
+    {
+        int event_id;
+        std::future<BlockBuffer> bytes;
+        PrefetchedEvent prefetched;
+    };
+
+    using BlockFiles = std::map<std::string, std::unique_ptr<BlockFile>>;
+
+    void prefetch_blocks(int first_event, int last_event);
+    auto start_read(int event_id, BlockFiles& files) -> PendingRead;
+    auto finish_read(PendingRead& read) -> PrefetchedEvent;
+
+    void start_stream();
+    void stream_events();
+
 public:
+    void stop_stream();
     void reset();
 
 private:
@@ -84,12 +285,49 @@ private:
     int event_count_;
 
     std::set<long> processing_events_;
+    std::map<long, int> processing_batches_;
     int eof_request_count_;
 
+    // the failed event that ended the last batch
+    std::optional<PrefetchedEvent> deferred_event_;
+
 private:
     EventReaderService* service_;
 
     std::mutex mutex_;
+
+    // serializes the calls to the subclass when the events are prefetched
+    std::mutex io_mutex_;
+
+private:
+    // the next events are read by the prefetch thread into a ring buffer
+    int prefetch_depth_ = 0;
+    std::thread prefetch_thread_;
+    std::vector<PrefetchedEvent> ring_;
+    std::size_t ring_head_ = 0;
+    std::size_t ring_size_ = 0;
+    bool stop_prefetch_ = false;
+    std::mutex ring_mutex_;
+    std::condition_variable ring_not_empty_;
+    std::condition_variable ring_not_full_;
+
+    // the block reads of the prefetch thread
+    int io_depth_ = 0;
+    bool direct_io_ = false;
+    std::unique_ptr<BlockIO> block_io_;
+
+private:
+    // the events are published by the stream thread, guarded by mutex_,
+    // with the emitter of the last request that asked for the stream
+    int stream_window_ = 0;
+    std::shared_ptr<Emitter> emitter_;
+    std::thread stream_thread_;
+    bool stop_stream_ = false;
+    std::condition_variable stream_credits_;
+
+private:
+    std::once_flag batch_type_flag_;
+    std::unique_ptr<EngineDataType> batch_type_;
 };
 
 
@@ -108,7 +346,11 @@ EventReaderService::Impl::Impl(EventReaderService* service)
     // nop
 }
 
-EventReaderService::Impl::~Impl() = default;
+EventReaderService::Impl::~Impl()
+{
+    stop_stream();
+    stop_prefetch();
+}
 
 
 auto EventReaderService::configure(EngineData& input) -> EngineData
@@ -141,6 +383,8 @@ auto EventReaderService::configure(EngineData& input) -> EngineData
 
 void EventReaderService::Impl::open_file(const json11::Json& config_data)
 {
+    stop_stream();
+
     std::unique_lock<std::mutex> lock{mutex_};
 
     if (has_file()) {
@@ -153,8 +397,12 @@ void EventReaderService::Impl::open_file(const json11::Json& config_data)
     try {
         service_->open_file(file_name_, config_data);
         set_limits(config_data);
+        set_prefetch(config_data);
+        set_stream(config_data);
         std::cout << service_->name() << " opened file " << file_name_
                   << std::endl;
+        start_prefetch();
+        stop_stream_ = false;
     } catch (const EventReaderError& e) {
         std::cerr << service_->name() << " could not open file " << e.what()
                   << std::endl;
@@ -184,7 +432,36 @@ void EventReaderService::Impl::set_limits(const json11::Json& config_data)
     last_event_ = skip_events + max_events;
 
     processing_events_.clear();
+    processing_batches_.clear();
     eof_request_count_ = 0;
+    deferred_event_.reset();
+}
+
+
+void EventReaderService::Impl::set_prefetch(const json11::Json& config_data)
+{
+    io_depth_ = get_value(config_data, conf_io_depth, 0, 0, max_io_depth);
+    direct_io_ = config_data[conf_direct].bool_value();
+    prefetch_depth_ = get_value(config_data, conf_prefetch, io_depth_, 0, max_prefetch);
+    if (io_depth_ > 0) {
+        std::cout << service_->name() << " config: " << io_depth_
+                  << (direct_io_ ? " direct" : "") << " block reads in flight"
+                  << std::endl;
+    }
+    if (prefetch_depth_ > 0) {
+        std::cout << service_->name() << " config: prefetch " << prefetch_depth_
+                  << " events" << std::endl;
+    }
+}
+
+
+void EventReaderService::Impl::set_stream(const json11::Json& config_data)
+{
+    stream_window_ = get_value(config_data, conf_stream, 0, 0, max_stream);
+    if (stream_window_ > 0) {
+        std::cout << service_->name() << " config: stream " << stream_window_
+                  << " events" << std::endl;
+    }
 }
 
 
@@ -212,6 +489,8 @@ auto EventReaderService::Impl::get_value(const json11::Json& config_data,
 
 void EventReaderService::Impl::close_file(const json11::Json& config_data)
 {
+    stop_stream();
+
     std::unique_lock<std::mutex> lock{mutex_};
 
     file_name_ = get_string(config_data, conf_filename);
@@ -230,6 +509,7 @@ void EventReaderService::Impl::close_file(const json11::Json& config_data)
 
 void EventReaderService::Impl::close_file()
 {
+    stop_prefetch();
     service_->close_file();
     std::cout << service_->name() << " closed file " << file_name_ << std::endl;
 }
@@ -237,17 +517,20 @@ void EventReaderService::Impl::close_file()
 
 auto EventReaderService::execute(EngineData& input) -> EngineData
 {
+    auto emitter = std::exchange(request_emitter, nullptr);
     auto output = EngineData();
 
     const auto& dt = input.mime_type();
     if (dt == type::STRING) {
         const auto& request = data_cast<std::string>(input);
         if (request == request_next || request == request_next_rec) {
-            impl_->get_next_event(input, output);
+            impl_->get_next_event(input, std::move(emitter), output);
         } else if (request == request_order) {
             impl_->get_file_byte_order(output);
         } else if (request == request_count) {
             impl_->get_event_count(output);
+        } else if (auto batch = parse_batch_request(request)) {
+            impl_->get_next_batch(input, *batch, output);
         } else {
             util::set_error(output, "Wrong input data: " + request);
         }
@@ -266,6 +549,7 @@ inline auto EventReaderService::Impl::is_rec_request(const EngineData& input) ->
 
 
 void EventReaderService::Impl::get_next_event(const EngineData& input,
+                                              std::shared_ptr<Emitter> emitter,
                                               EngineData& output)
 {
     std::unique_lock<std::mutex> lock{mutex_};
@@ -276,21 +560,51 @@ void EventReaderService::Impl::get_next_event(const EngineData& input,
     }
     if (!has_file()) {
         util::set_error(output, open_error_, 1);
+    } else if (stream_window_ > 0 && emitter && current_event_ < last_event_) {
+        // the event is published by the stream thread
+        emitter_ = std::move(emitter);
+        start_stream();
+        stream_credits_.notify_one();
     } else if (current_event_ < last_event_) {
         return_next_event(output);
     } else {
-        util::set_error(output, end_of_file, 1);
-        if (from_rec) {
-            if (processing_events_.empty()) {
-                eof_request_count_++;
-                util::set_error(output, end_of_file, eof_request_count_ + 1);
-                output.set_data(type::INT32, eof_request_count_);
-            } else {
-                output.set_data(type::INT32, eof_waiting_rec);
-            }
+        return_end_of_file(from_rec, output);
+    }
+}
+
+
+void EventReaderService::Impl::get_next_batch(const EngineData& input,
+                                              const BatchRequest& request,
+                                              EngineData& output)
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+
+    if (request.from_rec) {
+        finish_batch(input.communication_id());
+    }
+    if (!has_file()) {
+        util::set_error(output, open_error_, 1);
+    } else if (current_event_ < last_event_) {
+        return_next_batch(request.size, output);
+    } else {
+        return_end_of_file(request.from_rec, output);
+    }
+}
+
+
+void EventReaderService::Impl::return_end_of_file(bool from_rec, EngineData& output)
+{
+    util::set_error(output, end_of_file, 1);
+    if (from_rec) {
+        if (processing_events_.empty()) {
+            eof_request_count_++;
+            util::set_error(output, end_of_file, eof_request_count_ + 1);
+            output.set_data(type::INT32, eof_request_count_);
         } else {
-            output.set_data(type::INT32, eof_not_from_writer);
+            output.set_data(type::INT32, eof_waiting_rec);
         }
+    } else {
+        output.set_data(type::INT32, eof_not_from_writer);
     }
 }
 
@@ -301,8 +615,11 @@ void EventReaderService::Impl::return_next_event(EngineData& output)
         auto event_id = current_event_++;
         output.set_communication_id(event_id);
 
-        auto event = service_->read_event(event_id);
-        output.set_data(service_->get_data_type(), std::move(event));
+        auto next = next_event(event_id);
+        if (next.error) {
+            std::rethrow_exception(next.error);
+        }
+        output.set_data(service_->get_data_type(), std::move(next.event));
         output.set_description("data");
 
         processing_events_.insert(event_id);
@@ -316,12 +633,318 @@ void EventReaderService::Impl::return_next_event(EngineData& output)
 }
 
 
+void EventReaderService::Impl::return_next_batch(int size, EngineData& output)
+{
+    auto first_event = current_event_;
+    auto batch = EventBatch{};
+    batch.event_ids.reserve(static_cast<std::size_t>(size));
+    batch.events.reserve(static_cast<std::size_t>(size));
+
+    while (static_cast<int>(batch.events.size()) < size && current_event_ < last_event_) {
+        auto next = next_event(current_event_);
+        if (next.error) {
+            // the error is returned alone, as for a single event request
+            deferred_event_ = std::move(next);
+            if (batch.events.empty()) {
+                return_next_event(output);
+                return;
+            }
+            break;
+        }
+        batch.event_ids.push_back(current_event_);
+        batch.events.push_back(std::move(next.event));
+        processing_events_.insert(current_event_);
+        ++current_event_;
+    }
+
+    processing_batches_[first_event] = static_cast<int>(batch.events.size());
+    output.set_communication_id(first_event);
+    output.set_data(batch_type(), std::move(batch));
+    output.set_description("data");
+}
+
+
+void EventReaderService::Impl::finish_batch(long event_id)
+{
+    auto it = processing_batches_.find(event_id);
+    if (it == processing_batches_.end()) {
+        processing_events_.erase(event_id);
+        return;
+    }
+    for (auto id = event_id; id < event_id + it->second; ++id) {
+        processing_events_.erase(id);
+    }
+    processing_batches_.erase(it);
+}
+
+
+auto EventReaderService::Impl::next_event(int event_id) -> PrefetchedEvent
+{
+    if (deferred_event_) {
+        auto next = std::move(*deferred_event_);
+        deferred_event_.reset();
+        return next;
+    }
+    if (prefetch_thread_.joinable()) {
+        return next_prefetched_event();
+    }
+    auto next = PrefetchedEvent{};
+    try {
+        std::unique_lock<std::mutex> io_lock{io_mutex_};
+        next.event = service_->read_event(event_id);
+    } catch (const EventReaderError&) {
+        next.error = std::current_exception();
+    }
+    return next;
+}
+
+
+auto EventReaderService::Impl::batch_type() -> const EngineDataType&
+{
+    std::call_once(batch_type_flag_, [this] {
+        batch_type_ = std::make_unique<EngineDataType>(
+                make_event_batch_type(service_->get_data_type()));
+    });
+    return *batch_type_;
+}
+
+
+void EventReaderService::Impl::start_prefetch()
+{
+    if (prefetch_depth_ == 0 || current_event_ >= last_event_) {
+        return;
+    }
+    block_io_.reset();
+    if (io_depth_ > 0) {
+        block_io_ = std::make_unique<BlockIO>(std::min(io_depth_, max_io_threads));
+    }
+    ring_.assign(static_cast<std::size_t>(prefetch_depth_), PrefetchedEvent{});
+    ring_head_ = 0;
+    ring_size_ = 0;
+    stop_prefetch_ = false;
+    prefetch_thread_ = std::thread{[this, first = current_event_, last = last_event_] {
+        prefetch_events(first, last);
+    }};
+}
+
+
+void EventReaderService::Impl::stop_prefetch()
+{
+    if (!prefetch_thread_.joinable()) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock{ring_mutex_};
+        stop_prefetch_ = true;
+    }
+    ring_not_full_.notify_all();
+    prefetch_thread_.join();
+    ring_.clear();
+}
+
+
+void EventReaderService::Impl::prefetch_events(int first_event, int last_event)
+{
+    if (block_io_) {
+        prefetch_blocks(first_event, last_event);
+        return;
+    }
+    for (auto event_id = first_event; event_id < last_event; ++event_id) {
+        auto prefetched = PrefetchedEvent{};
+        try {
+            std::unique_lock<std::mutex> io_lock{io_mutex_};
+            prefetched.event = service_->read_event(event_id);
+        } catch (...) {
+            // reported when the event is requested
+            prefetched.error = std::current_exception();
+        }
+        if (!put_prefetched_event(std::move(prefetched))) {
+            return;
+        }
+    }
+}
+
+
+auto EventReaderService::Impl::put_prefetched_event(PrefetchedEvent prefetched) -> bool
+{
+    std::unique_lock<std::mutex> lock{ring_mutex_};
+    ring_not_full_.wait(lock, [this] {
+        return stop_prefetch_ || ring_size_ < ring_.size();
+    });
+    if (stop_prefetch_) {
+        return false;
+    }
+    ring_[(ring_head_ + ring_size_) % ring_.size()] = std::move(prefetched);
+    ++ring_size_;
+    lock.unlock();
+    ring_not_empty_.notify_one();
+    return true;
+}
+
+
+void EventReaderService::Impl::prefetch_blocks(int first_event, int last_event)
+{
+    auto files = BlockFiles{};
+    auto pending = std::deque<PendingRead>{};
+    auto event_id = first_event;
+    while (event_id < last_event || !pending.empty()) {
+        if (event_id < last_event && static_cast<int>(pending.size()) < io_depth_) {
+            pending.push_back(start_read(event_id++, files));
+            continue;
+        }
+        if (!put_prefetched_event(finish_read(pending.front()))) {
+            break;
+        }
+        pending.pop_front();
+    }
+
+    // the files must stay open until the reads are done
+    for (auto& read : pending) {
+        if (read.bytes.valid()) {
+            read.bytes.wait();
+        }
+    }
+}
+
+
+auto EventReaderService::Impl::start_read(int event_id, BlockFiles& files) -> PendingRead
+{
+    auto read = PendingRead{event_id, {}, {}};
+    try {
+        std::unique_lock<std::mutex> io_lock{io_mutex_};
+        auto record = service_->locate_event(event_id);
+        if (!record) {
+            read.prefetched.event = service_->read_event(event_id);
+            return read;
+        }
+        io_lock.unlock();
+
+        auto& file = files[record->file];
+        if (!file) {
+            file = std::make_unique<BlockFile>(record->file, BlockFile::Mode::Read,
+                                               direct_io_);
+        }
+        read.bytes = block_io_->read(*file, record->offset, record->size);
+    } catch (const BlockIOError& e) {
+        read.prefetched.error = std::make_exception_ptr(EventReaderError{e.what()});
+    } catch (...) {
+        read.prefetched.error = std::current_exception();
+    }
+    return read;
+}
+
+
+auto EventReaderService::Impl::finish_read(PendingRead& read) -> PrefetchedEvent
+{
+    if (!read.bytes.valid()) {
+        return std::move(read.prefetched);
+    }
+    auto prefetched = PrefetchedEvent{};
+    try {
+        auto bytes = read.bytes.get();
+        std::unique_lock<std::mutex> io_lock{io_mutex_};
+        prefetched.event = service_->decode_event(read.event_id, bytes.data(), bytes.size());
+    } catch (const BlockIOError& e) {
+        prefetched.error = std::make_exception_ptr(EventReaderError{e.what()});
+    } catch (...) {
+        prefetched.error = std::current_exception();
+    }
+    return prefetched;
+}
+
+
+auto EventReaderService::Impl::next_prefetched_event() -> PrefetchedEvent
+{
+    // the requests never go beyond the last prefetched event
+    std::unique_lock<std::mutex> lock{ring_mutex_};
+    ring_not_empty_.wait(lock, [this] { return ring_size_ > 0; });
+    auto prefetched = std::move(ring_[ring_head_]);
+    ring_head_ = (ring_head_ + 1) % ring_.size();
+    --ring_size_;
+    lock.unlock();
+    ring_not_full_.notify_one();
+    return prefetched;
+}
+
+
+void EventReaderService::set_emitter(std::shared_ptr<Emitter> emitter)
+{
+    request_emitter = std::move(emitter);
+}
+
+
+void EventReaderService::Impl::start_stream()
+{
+    if (stream_thread_.joinable() || stop_stream_) {
+        return;
+    }
+    stream_thread_ = std::thread{[this] { stream_events(); }};
+}
+
+
+void EventReaderService::Impl::stop_stream()
+{
+    // the thread needs the main lock to finish, so it is joined without it
+    auto thread = std::thread{};
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        stop_stream_ = true;
+        thread = std::move(stream_thread_);
+    }
+    stream_credits_.notify_all();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+
+void EventReaderService::Impl::stream_events()
+{
+    std::unique_lock<std::mutex> lock{mutex_};
+    while (true) {
+        stream_credits_.wait(lock, [this] {
+            return stop_stream_ || current_event_ >= last_event_ ||
+                   static_cast<int>(processing_events_.size()) < stream_window_;
+        });
+        if (stop_stream_ || current_event_ >= last_event_) {
+            return;
+        }
+
+        // nobody else can catch the errors of this thread,
+        // so they are published as the result of the event
+        auto output = EngineData{};
+        try {
+            return_next_event(output);
+        } catch (const std::exception& e) {
+            util::set_error(output, "Error requesting event from file " + file_name_ +
+                                    "\n\n" + e.what(), 1);
+        } catch (...) {
+            util::set_error(output, "Error requesting event from file " + file_name_, 1);
+        }
+        auto emitter = emitter_;
+
+        lock.unlock();
+        try {
+            emitter->emit(output);
+        } catch (const std::exception& e) {
+            std::cerr << service_->name() << " could not publish event "
+                      << output.communication_id() << ": " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << service_->name() << " could not publish event "
+                      << output.communication_id() << std::endl;
+        }
+        lock.lock();
+    }
+}
+
+
 void EventReaderService::Impl::get_file_byte_order(EngineData& output)
 {
     std::unique_lock<std::mutex> lock{mutex_};
 
     if (has_file()) {
         try {
+            std::unique_lock<std::mutex> io_lock{io_mutex_};
             auto order = get_order(service_->read_byte_order());
             output.set_data(type::STRING, order);
             output.set_description("byte order");
@@ -362,6 +985,14 @@ void EventReaderService::Impl::get_event_count(EngineData& output)
 }
 
 
+auto EventReaderService::decode_event(int /*event_number*/,
+                                      const std::uint8_t* /*data*/,
+                                      std::size_t /*size*/) -> std::any
+{
+    throw EventReaderError{"the reader cannot decode events"};
+}
+
+
 auto EventReaderService::execute_group(const std::vector<EngineData>& /*inputs*/)
     -> EngineData
 {
@@ -377,7 +1008,7 @@ auto EventReaderService::input_data_types() const -> std::vector<EngineDataType>
 
 auto EventReaderService::output_data_types() const -> std::vector<EngineDataType>
 {
-    return {get_data_type(), type::STRING, type::INT32};
+    return {get_data_type(), impl_->batch_type(), type::STRING, type::INT32};
 }
 
 
@@ -395,6 +1026,8 @@ void EventReaderService::reset()
 
 void EventReaderService::Impl::reset()
 {
+    stop_stream();
+
     std::unique_lock<std::mutex> lock{mutex_};
     if (has_file()) {
         close_file();
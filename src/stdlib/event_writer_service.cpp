@@ -6,13 +6,24 @@
 
 #include <clara/stdlib/event_writer_service.hpp>
 
+#include <clara/stdlib/block_io.hpp>
 #include <clara/stdlib/json_utils.hpp>
 
 #include "service_utils.hpp"
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <iostream>
+#include <map>
 #include <mutex>
+#include <optional>
+#include <shared_mutex>
 #include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
 
 
 using namespace std::literals::string_view_literals;
@@ -26,12 +37,33 @@ constexpr auto conf_order = "order"sv;
 constexpr auto conf_action_open = "open"sv;
 constexpr auto conf_action_close = "close"sv;
 constexpr auto conf_action_skip = "skip"sv;
+constexpr auto conf_queue_size = "queue"sv;
+constexpr auto conf_ordered = "ordered"sv;
+constexpr auto conf_reorder_size = "reorder_size"sv;
+constexpr auto conf_events_skip = "skip"sv;
+constexpr auto conf_io_depth = "io_depth"sv;
+constexpr auto conf_direct = "direct"sv;
+
+constexpr auto max_queue_size = 4096;
+constexpr auto default_reorder_size = 1024;
+constexpr auto max_reorder_size = 65536;
+constexpr auto max_io_depth = 1024;
+constexpr auto max_io_threads = 16;
 
 constexpr auto output_next = "next-rec"sv;
 constexpr auto event_skip = "skip"sv;
 
 constexpr auto no_file = "No open file"sv;
 
+void update_max(std::atomic<long>& max, long value)
+{
+    auto current = max.load(std::memory_order_relaxed);
+    while (value > current
+            && !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+        // retry
+    }
+}
+
 } // namespace
 
 
@@ -47,26 +79,100 @@ public:
     void open_file(const json11::Json& config_data);
     void close_file(const json11::Json& config_data);
 
-    auto has_file() -> bool { return service_->has_file(); }
+    auto has_file() -> bool
+    {
+        std::unique_lock<std::mutex> io_lock{io_mutex_};
+        return service_->has_file();
+    }
     void close_file();
     void skip_all();
 
 public:
-    void write_event(const EngineData& input, EngineData& output);
+    void write_event(EngineData& input, EngineData& output);
+
+    auto block_writes() const -> BlockWrites
+    {
+        return {block_io_.get(), io_depth_, direct_io_};
+    }
+
+    auto queued_events() const -> long
+    {
+        return queued_events_.load(std::memory_order_relaxed);
+    }
+
+    auto reorder_stats() const -> ReorderStats
+    {
+        return {
+            reorder_stalls_.load(std::memory_order_relaxed),
+            reorder_high_water_.load(std::memory_order_relaxed),
+        };
+    }
 
 public:
     void reset();
 
+private:
+    void set_block_io(const json11::Json& config_data);
+
+private:
+    void set_queue(const json11::Json& config_data);
+    void start_queue();
+    void stop_queue();
+    auto queue_event(std::any& event, EngineData& output) -> bool;
+    void write_queued_events();
+
+private:
+    void set_order(const json11::Json& config_data);
+    auto reorder_event(EngineData& input, EngineData& output) -> bool;
+    void release_event(std::any& event, EngineData& output);
+    void flush_reorder_buffer();
+    auto write_error(const EventWriterError& e) -> std::string;
+
 private:
     std::string file_name_;
     std::string open_error_ = std::string{no_file};
 
     bool skip_events_ = false;
-    int event_counter_ = 0;
+    std::atomic<int> event_counter_{0};
 
     EventWriterService* service_;
 
     std::mutex mutex_;
+
+    // serializes the calls to the subclass when the events are queued
+    std::mutex io_mutex_;
+
+    // taken by the concurrent writes, and exclusively to open or close files
+    std::shared_mutex file_mutex_;
+
+private:
+    // the events are written in the background if the queue is enabled
+    int queue_size_ = 0;
+    bool queue_open_ = false;
+    std::deque<std::any> queue_;
+    std::optional<std::string> queue_error_;
+    std::atomic<long> queued_events_{0};
+    std::thread queue_thread_;
+    std::mutex queue_mutex_;
+    std::condition_variable queue_not_empty_;
+    std::condition_variable queue_not_full_;
+
+private:
+    // the events are released by communication ID if the output is ordered,
+    // skipped events are kept as empty values
+    bool ordered_ = false;
+    int reorder_size_ = default_reorder_size;
+    long next_event_ = 0;
+    std::map<long, std::any> reorder_buffer_;
+    std::mutex reorder_mutex_;
+    std::atomic<long> reorder_stalls_{0};
+    std::atomic<long> reorder_high_water_{0};
+
+private:
+    // the I/O threads for the subclass, while the file is open
+    int io_depth_ = 0;
+    bool direct_io_ = false;
+    std::unique_ptr<BlockIO> block_io_;
 };
 
 
@@ -85,7 +191,10 @@ EventWriterService::Impl::Impl(EventWriterService* service)
     // nop
 }
 
-EventWriterService::Impl::~Impl() = default;
+EventWriterService::Impl::~Impl()
+{
+    stop_queue();
+}
 
 
 auto EventWriterService::configure(EngineData& input) -> EngineData
@@ -130,10 +239,18 @@ void EventWriterService::Impl::open_file(const json11::Json& config_data)
     std::cout << service_->name() << " request to open file " << file_name_
               << std::endl;
     try {
-        service_->open_file(file_name_, config_data);
+        {
+            std::unique_lock<std::shared_mutex> file_lock{file_mutex_};
+            std::unique_lock<std::mutex> io_lock{io_mutex_};
+            set_block_io(config_data);
+            service_->open_file(file_name_, config_data);
+        }
         event_counter_ = 0;
+        set_queue(config_data);
+        set_order(config_data);
         std::cout << service_->name() << " opened file " << file_name_
                   << std::endl;
+        start_queue();
     } catch (const EventWriterError& e) {
         std::cerr << service_->name() << " could not open file " << e.what()
                   << std::endl;
@@ -164,7 +281,12 @@ void EventWriterService::Impl::close_file(const json11::Json& config_data)
 
 void EventWriterService::Impl::close_file()
 {
+    flush_reorder_buffer();
+    stop_queue();
+    std::unique_lock<std::shared_mutex> file_lock{file_mutex_};
+    std::unique_lock<std::mutex> io_lock{io_mutex_};
     service_->close_file();
+    block_io_.reset();
     std::cout << service_->name() << " closed file " << file_name_ << std::endl;
 }
 
@@ -198,27 +320,56 @@ auto EventWriterService::execute(EngineData& input) -> EngineData
 }
 
 
-void EventWriterService::Impl::write_event(const EngineData& input,
+void EventWriterService::Impl::write_event(EngineData& input,
                                            EngineData& output)
 {
-    if (skip_events_ || input.description() == event_skip) {
+    if (skip_events_) {
         output.set_data(type::STRING, output_next);
         output.set_description("event skipped");
         return;
     }
 
+    if (reorder_event(input, output)) {
+        return;
+    }
+
+    if (input.description() == event_skip) {
+        output.set_data(type::STRING, output_next);
+        output.set_description("event skipped");
+        return;
+    }
+
+    if (queue_event(input.data(), output)) {
+        return;
+    }
+
+    if (service_->concurrent_writes()) {
+        std::shared_lock<std::shared_mutex> file_lock{file_mutex_};
+        if (service_->has_file()) {
+            try {
+                service_->write_event(std::as_const(input).data());
+                event_counter_++;
+                output.set_data(type::STRING, output_next);
+                output.set_description("event saved");
+            } catch (const EventWriterError& e) {
+                util::set_error(output, write_error(e));
+            }
+        } else {
+            util::set_error(output, no_file);
+        }
+        return;
+    }
+
     auto lock = std::unique_lock<std::mutex>{mutex_};
     if (has_file()) {
         try {
-            service_->write_event(input.data());
+            std::unique_lock<std::mutex> io_lock{io_mutex_};
+            service_->write_event(std::as_const(input).data());
             event_counter_++;
             output.set_data(type::STRING, output_next);
             output.set_description("event saved");
         } catch (const EventWriterError& e) {
-            auto msg = std::ostringstream{};
-            msg << "Error saving event to file " << file_name_ << "\n\n"
-                << e.what();
-            util::set_error(output, msg.str());
+            util::set_error(output, write_error(e));
         }
     } else {
         util::set_error(output, open_error_);
@@ -226,6 +377,323 @@ void EventWriterService::Impl::write_event(const EngineData& input,
 }
 
 
+auto EventWriterService::Impl::write_error(const EventWriterError& e) -> std::string
+{
+    auto msg = std::ostringstream{};
+    msg << "Error saving event to file " << file_name_ << "\n\n" << e.what();
+    return msg.str();
+}
+
+
+void EventWriterService::Impl::set_block_io(const json11::Json& config_data)
+{
+    io_depth_ = 0;
+    if (has_key(config_data, conf_io_depth)) {
+        auto depth = get_int(config_data, conf_io_depth);
+        if (depth >= 0 && depth <= max_io_depth) {
+            io_depth_ = depth;
+        } else {
+            std::cerr << service_->name() << " config: invalid value for \""
+                      << conf_io_depth << "\": " << depth << std::endl;
+        }
+    }
+    direct_io_ = config_data[conf_direct].bool_value();
+
+    block_io_.reset();
+    if (io_depth_ > 0) {
+        block_io_ = std::make_unique<BlockIO>(std::min(io_depth_, max_io_threads));
+        std::cout << service_->name() << " config: " << io_depth_
+                  << (direct_io_ ? " direct" : "") << " block writes in flight"
+                  << std::endl;
+    }
+}
+
+
+void EventWriterService::Impl::set_queue(const json11::Json& config_data)
+{
+    queue_size_ = 0;
+    if (has_key(config_data, conf_queue_size)) {
+        auto size = get_int(config_data, conf_queue_size);
+        if (size >= 0 && size <= max_queue_size) {
+            queue_size_ = size;
+        } else {
+            std::cerr << service_->name() << " config: invalid value for \""
+                      << conf_queue_size << "\": " << size << std::endl;
+        }
+    }
+    if (queue_size_ > 0) {
+        std::cout << service_->name() << " config: queue " << queue_size_
+                  << " events" << std::endl;
+    }
+}
+
+
+void EventWriterService::Impl::start_queue()
+{
+    if (queue_size_ == 0) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock{queue_mutex_};
+        queue_open_ = true;
+        queue_error_.reset();
+    }
+    queue_thread_ = std::thread{[this] { write_queued_events(); }};
+}
+
+
+void EventWriterService::Impl::stop_queue()
+{
+    if (!queue_thread_.joinable()) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock{queue_mutex_};
+        queue_open_ = false;
+    }
+    queue_not_empty_.notify_all();
+    queue_not_full_.notify_all();
+    queue_thread_.join();
+
+    std::unique_lock<std::mutex> lock{queue_mutex_};
+    if (queue_error_) {
+        std::cerr << service_->name() << " " << *queue_error_ << std::endl;
+        queue_error_.reset();
+    }
+}
+
+
+auto EventWriterService::Impl::queue_event(std::any& event,
+                                           EngineData& output) -> bool
+{
+    std::unique_lock<std::mutex> lock{queue_mutex_};
+    queue_not_full_.wait(lock, [this] {
+        return !queue_open_ || queue_.size() < static_cast<std::size_t>(queue_size_);
+    });
+    if (!queue_open_) {
+        return false;
+    }
+
+    queue_.push_back(std::move(event));
+    queued_events_.fetch_add(1, std::memory_order_relaxed);
+
+    if (queue_error_) {
+        util::set_error(output, *queue_error_);
+        queue_error_.reset();
+    } else {
+        output.set_data(type::STRING, output_next);
+        output.set_description("event queued");
+    }
+    lock.unlock();
+    queue_not_empty_.notify_one();
+    return true;
+}
+
+
+void EventWriterService::Impl::write_queued_events()
+{
+    auto events = std::vector<std::any>{};
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock{queue_mutex_};
+            queue_not_empty_.wait(lock, [this] {
+                return !queue_open_ || !queue_.empty();
+            });
+            if (queue_.empty()) {
+                return;
+            }
+            // all the queued events are written together
+            events.assign(std::make_move_iterator(queue_.begin()),
+                          std::make_move_iterator(queue_.end()));
+            queue_.clear();
+        }
+        queue_not_full_.notify_all();
+
+        auto error = std::optional<std::string>{};
+        try {
+            std::unique_lock<std::mutex> io_lock{io_mutex_};
+            service_->write_events(events);
+            event_counter_ += static_cast<int>(events.size());
+        } catch (const EventWriterError& e) {
+            error = write_error(e);
+        }
+        queued_events_.fetch_sub(static_cast<long>(events.size()),
+                                 std::memory_order_relaxed);
+        events.clear();
+
+        if (error) {
+            std::unique_lock<std::mutex> lock{queue_mutex_};
+            queue_error_ = std::move(error);
+        }
+    }
+}
+
+
+void EventWriterService::Impl::set_order(const json11::Json& config_data)
+{
+    std::unique_lock<std::mutex> lock{reorder_mutex_};
+
+    ordered_ = has_key(config_data, conf_ordered) && get_bool(config_data, conf_ordered);
+    reorder_size_ = default_reorder_size;
+    next_event_ = 0;
+    reorder_buffer_.clear();
+    if (!ordered_) {
+        return;
+    }
+    if (has_key(config_data, conf_reorder_size)) {
+        auto size = get_int(config_data, conf_reorder_size);
+        if (size > 0 && size <= max_reorder_size) {
+            reorder_size_ = size;
+        } else {
+            std::cerr << service_->name() << " config: invalid value for \""
+                      << conf_reorder_size << "\": " << size << std::endl;
+        }
+    }
+    if (has_key(config_data, conf_events_skip)) {
+        next_event_ = std::max(get_int(config_data, conf_events_skip), 0);
+    }
+    std::cout << service_->name() << " config: ordered output, up to "
+              << reorder_size_ << " buffered events" << std::endl;
+}
+
+
+auto EventWriterService::Impl::reorder_event(EngineData& input,
+                                             EngineData& output) -> bool
+{
+    std::unique_lock<std::mutex> lock{reorder_mutex_};
+    if (!ordered_) {
+        return false;
+    }
+
+    auto event_id = input.communication_id();
+    if (event_id < next_event_) {
+        // too late to be ordered, written as usual
+        return false;
+    }
+
+    auto event = std::any{};
+    if (input.description() != event_skip) {
+        event = std::move(input.data());
+    }
+    reorder_buffer_.insert_or_assign(event_id, std::move(event));
+    if (event_id != next_event_) {
+        reorder_stalls_.fetch_add(1, std::memory_order_relaxed);
+    }
+    update_max(reorder_high_water_, static_cast<long>(reorder_buffer_.size()));
+
+    output.set_data(type::STRING, output_next);
+    output.set_description("event buffered");
+
+    // a full buffer gives up on the missing events
+    auto it = reorder_buffer_.begin();
+    while (it != reorder_buffer_.end()
+            && (it->first == next_event_
+                || reorder_buffer_.size() > static_cast<std::size_t>(reorder_size_))) {
+        if (it->first != next_event_) {
+            std::cerr << service_->name() << " missing events " << next_event_
+                      << " to " << it->first - 1 << " in ordered output"
+                      << std::endl;
+        }
+        next_event_ = it->first + 1;
+        auto released = EngineData{};
+        release_event(it->second, released);
+        if (released.status() != EngineStatus::ERROR) {
+            if (it->first == event_id && !released.description().empty()) {
+                output.set_description(released.description());
+            }
+        } else if (output.status() != EngineStatus::ERROR) {
+            // the first failure is reported to this request
+            util::set_error(output, "event " + std::to_string(it->first) + ": "
+                                    + released.description());
+        } else {
+            std::cerr << service_->name() << " event " << it->first << ": "
+                      << released.description() << std::endl;
+        }
+        it = reorder_buffer_.erase(it);
+    }
+    return true;
+}
+
+
+void EventWriterService::Impl::release_event(std::any& event, EngineData& output)
+{
+    if (!event.has_value()) {
+        return;
+    }
+    if (queue_event(event, output)) {
+        return;
+    }
+
+    std::unique_lock<std::mutex> io_lock{io_mutex_};
+    if (service_->has_file()) {
+        try {
+            service_->write_event(event);
+            event_counter_++;
+            output.set_description("event saved");
+        } catch (const EventWriterError& e) {
+            util::set_error(output, write_error(e));
+        }
+    } else {
+        util::set_error(output, no_file);
+    }
+}
+
+
+void EventWriterService::Impl::flush_reorder_buffer()
+{
+    std::unique_lock<std::mutex> lock{reorder_mutex_};
+    if (!reorder_buffer_.empty()) {
+        std::cerr << service_->name() << " missing events before the last "
+                  << reorder_buffer_.size() << " buffered events" << std::endl;
+    }
+    for (auto& [event_id, event] : reorder_buffer_) {
+        auto output = EngineData{};
+        release_event(event, output);
+        if (output.status() == EngineStatus::ERROR) {
+            std::cerr << service_->name() << " " << output.description() << std::endl;
+        }
+    }
+    reorder_buffer_.clear();
+}
+
+
+void EventWriterService::write_events(const std::vector<std::any>& events)
+{
+    for (const auto& event : events) {
+        write_event(event);
+    }
+}
+
+
+auto EventWriterService::block_writes() const -> BlockWrites
+{
+    return impl_->block_writes();
+}
+
+
+auto EventWriterService::queued_events() const -> long
+{
+    return impl_->queued_events();
+}
+
+
+auto EventWriterService::reorder_stats() const -> ReorderStats
+{
+    return impl_->reorder_stats();
+}
+
+
+auto EventWriterService::stats() const -> Stats
+{
+    auto reorder = reorder_stats();
+    return {
+        {"queued_events", queued_events()},
+        {"reorder_stalls", reorder.stalls},
+        {"reorder_high_water", reorder.high_water},
+    };
+}
+
+
 auto EventWriterService::execute_group(const std::vector<EngineData>& /*inputs*/)
     -> EngineData
 {
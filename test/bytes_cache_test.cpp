@@ -0,0 +1,67 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "bytes_cache.hpp"
+
+#include <gmock/gmock.h>
+
+#include <any>
+#include <cstdint>
+#include <vector>
+
+using namespace testing;
+
+using clara::util::BytesCache;
+
+
+TEST(BytesCache, ReusesReleasedSharedBuffers)
+{
+    auto shared = BytesCache::acquire_shared(std::vector<std::uint8_t>(4, 1));
+    const auto* ptr = shared.get();
+
+    BytesCache::release_shared(std::move(shared));
+    auto reused = BytesCache::acquire_shared(std::vector<std::uint8_t>{2, 3});
+
+    EXPECT_THAT(shared, IsNull());
+    EXPECT_THAT(reused.get(), Eq(ptr));
+    EXPECT_THAT(*reused, ElementsAre(2, 3));
+}
+
+
+TEST(BytesCache, DoesNotReuseSharedBuffersInUse)
+{
+    auto shared = BytesCache::acquire_shared(std::vector<std::uint8_t>(4, 1));
+    auto other = shared;
+    const auto* ptr = shared.get();
+
+    BytesCache::release_shared(std::move(shared));
+    auto next = BytesCache::acquire_shared(std::vector<std::uint8_t>{2, 3});
+
+    EXPECT_THAT(next.get(), Ne(ptr));
+    EXPECT_THAT(*other, ElementsAre(1, 1, 1, 1));
+}
+
+
+TEST(BytesCache, ReusesReleasedAnyObjects)
+{
+    auto data = BytesCache::acquire_any(std::vector<std::uint8_t>(4, 1));
+    const auto* ptr = std::any_cast<std::vector<std::uint8_t>>(&data);
+
+    BytesCache::release_any(std::move(data));
+    auto reused = BytesCache::acquire_any(std::vector<std::uint8_t>{2, 3});
+    const auto* bytes = std::any_cast<std::vector<std::uint8_t>>(&reused);
+
+    EXPECT_THAT(data.has_value(), IsFalse());
+    EXPECT_THAT(bytes, Eq(ptr));
+    EXPECT_THAT(*bytes, ElementsAre(2, 3));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
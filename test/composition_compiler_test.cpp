@@ -67,6 +67,58 @@ TEST(SimpleCompiler, MultipleCalls)
 }
 
 
+TEST(RouteCache, ResolveLinks)
+{
+    auto rc = RouteCache{"10.10.10.1_java:C:S2"};
+
+    auto route = rc.get(composition);
+
+    ASSERT_THAT(*route, SizeIs(1));
+    EXPECT_THAT(route->at(0).name, StrEq("10.10.10.1_java:C:S3"));
+    EXPECT_THAT(route->at(0).address.host(), StrEq("10.10.10.1"));
+    EXPECT_THAT(route->at(0).address.pub_port(), Eq(7771));
+    EXPECT_THAT(route->at(0).topic.str(), StrEq("10.10.10.1_java:C:S3"));
+}
+
+
+TEST(RouteCache, ResolveLinksWithCustomPort)
+{
+    auto rc = RouteCache{"10.10.10.1_java:C:S1"};
+
+    auto route = rc.get(R"(10.10.10.1_java:C:S1+)"
+                        R"(10.10.10.2%9000_cpp:C:S2;)");
+
+    ASSERT_THAT(*route, SizeIs(1));
+    EXPECT_THAT(route->at(0).address.host(), StrEq("10.10.10.2"));
+    EXPECT_THAT(route->at(0).address.pub_port(), Eq(9000));
+}
+
+
+TEST(RouteCache, ReuseCompiledRoutes)
+{
+    auto rc = RouteCache{"10.10.10.1_java:C:S3"};
+
+    std::string composition2 = R"(10.10.10.1_java:C:S1+)"
+                               R"(10.10.10.1_java:C:S3+)"
+                               R"(10.10.10.1_java:C:S5;)";
+
+    auto r1 = rc.get(composition);
+    auto r2 = rc.get(composition2);
+    auto r3 = rc.get(composition);
+
+    EXPECT_THAT(r1, Eq(r3));
+    EXPECT_THAT(r2->at(0).name, StrEq("10.10.10.1_java:C:S5"));
+}
+
+
+TEST(RouteCache, ServiceNotInComposition)
+{
+    auto rc = RouteCache{"10.10.10.1_java:C:S9"};
+
+    EXPECT_THROW(rc.get(composition), std::logic_error);
+}
+
+
 int main(int argc, char* argv[])
 {
     testing::InitGoogleTest(&argc, argv);
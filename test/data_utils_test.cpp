@@ -56,6 +56,39 @@ TEST(RequestParser, ParseServiceRequest)
 }
 
 
+TEST(RequestParser, ParseServiceRequestWithEngineMode)
+{
+    auto m = request("startService?master?E1?E1lib?3?undefined?undefined?per-worker");
+    auto p = util::RequestParser::build(m);
+
+    for (int i = 0; i < 7; ++i) {
+        p.next_string();
+    }
+
+    EXPECT_THAT(util::parse_engine_mode(p.next_string("shared")), Eq(true));
+}
+
+
+TEST(RequestParser, DefaultEngineModeIsShared)
+{
+    auto m = request("startService?master?E1?E1lib?3?undefined?undefined");
+    auto p = util::RequestParser::build(m);
+
+    for (int i = 0; i < 7; ++i) {
+        p.next_string();
+    }
+
+    EXPECT_THAT(util::parse_engine_mode(p.next_string("shared")), Eq(false));
+}
+
+
+TEST(RequestParser, InvalidEngineMode)
+{
+    EXPECT_THROW(util::parse_engine_mode("per-thread"), util::InvalidRequest);
+    EXPECT_THROW(util::parse_engine_mode(""), util::InvalidRequest);
+}
+
+
 TEST(RequestParser, InvalidMimeType)
 {
     auto m = cm::make_message(cm::Topic::raw("topic"), 34.8);
@@ -234,6 +234,210 @@ TEST(EngineData, SetCommunicationId)
 }
 
 
+TEST(DataTypeTable, FindByIdAndMimeType)
+{
+    auto t = clara::DataTypeTable{{clara::type::INT32, clara::type::JSON}};
+
+    EXPECT_THAT(t.find(clara::type::JSON.id()), Eq(&t.data_types()[1]));
+    EXPECT_THAT(t.find(clara::type::STRING.id()), Eq(nullptr));
+
+    EXPECT_THAT(t.find(clara::type::INT32.mime_type()), Eq(&t.data_types()[0]));
+    EXPECT_THAT(t.find(std::string{"binary/bytes"}), Eq(nullptr));
+}
+
+
+TEST(DataTypeTable, SerializeAndDeserialize)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto t = clara::DataTypeTable{{clara::type::INT32, clara::type::STRING}};
+    auto topic = clara::msg::Topic::raw("topic");
+
+    auto d = clara::EngineData{};
+    d.set_data(clara::type::INT32, 512);
+
+    auto m = e.serialize(d, topic, t);
+    auto r = e.deserialize(m, t);
+
+    EXPECT_THAT(m.datatype(), StrEq(clara::type::INT32.mime_type()));
+    EXPECT_THAT(clara::data_cast<std::int32_t>(r), Eq(512));
+}
+
+
+TEST(DataTypeTable, SerializeRawArrayWithByteOrder)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto t = clara::DataTypeTable{{clara::type::ARRAY_FLOAT}};
+    auto topic = clara::msg::Topic::raw("topic");
+
+    auto d = clara::EngineData{};
+    d.set_data(clara::type::ARRAY_FLOAT, std::vector<float>{1.f, 2.f});
+
+    auto m = e.serialize(d, topic, t);
+
+    EXPECT_THAT(m.meta()->byteorder(), Eq(clara::msg::proto::Meta::Little));
+    EXPECT_THAT(m.data().size(), Eq(2 * sizeof(float)));
+}
+
+
+TEST(DataTypeTable, RejectRawArrayWithBigEndianOrder)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto t = clara::DataTypeTable{{clara::type::ARRAY_FLOAT}};
+    auto topic = clara::msg::Topic::raw("topic");
+
+    auto meta = clara::msg::proto::make_meta();
+    meta->set_datatype(clara::type::ARRAY_FLOAT.mime_type());
+    meta->set_byteorder(clara::msg::proto::Meta::Big);
+    auto m = clara::msg::Message{topic, std::move(meta),
+                                 std::vector<std::uint8_t>(2 * sizeof(float))};
+
+    EXPECT_THROW(e.deserialize(m, t), std::runtime_error);
+}
+
+
+TEST(DataTypeTable, SerializeDataWithStringMimeType)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto t = clara::DataTypeTable{{clara::type::INT64}};
+    auto topic = clara::msg::Topic::raw("topic");
+
+    auto d = clara::EngineData{};
+    d.set_data(clara::type::INT64.mime_type(), std::int64_t{1024});
+
+    auto s = clara::EngineData{};
+    s.set_data(clara::type::STRING.mime_type(), "done");
+
+    auto j = clara::EngineData{};
+    j.set_data(clara::type::JSON.mime_type(), "{}");
+
+    EXPECT_THAT(e.serialize(d, topic, t).datatype(), StrEq(clara::type::INT64.mime_type()));
+    EXPECT_THAT(e.serialize(s, topic, t).datatype(), StrEq(clara::type::STRING.mime_type()));
+    EXPECT_THROW(e.serialize(j, topic, t), std::runtime_error);
+}
+
+
+class CountingSerializer : public clara::Serializer
+{
+public:
+    auto write(const std::any& data) const -> std::vector<std::uint8_t> override
+    {
+        ++writes;
+        return clara::type::STRING.serializer()->write(data);
+    }
+
+    auto read(const std::vector<std::uint8_t>& buffer) const -> std::any override
+    {
+        ++reads;
+        return clara::type::STRING.serializer()->read(buffer);
+    }
+
+    mutable int reads = 0;
+    mutable int writes = 0;
+};
+
+
+auto counting_type() -> std::pair<clara::EngineDataType, CountingSerializer*>
+{
+    auto s = std::make_unique<CountingSerializer>();
+    auto* p = s.get();
+    return {clara::EngineDataType{"text/counted", std::move(s)}, p};
+}
+
+
+TEST(EngineData, DeserializeOnFirstAccess)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto [dt, s] = counting_type();
+    auto t = clara::DataTypeTable{{dt}};
+
+    auto d = clara::EngineData{};
+    d.set_data(dt, std::string{"event"});
+    auto m = e.serialize(d, clara::msg::Topic::raw("topic"), t);
+
+    auto r = e.deserialize(m, t);
+
+    EXPECT_THAT(s->reads, Eq(0));
+    EXPECT_THAT(e.is_deserialized(r), Eq(false));
+    EXPECT_THAT(r.has_data(), Eq(true));
+    EXPECT_THAT(m.data(), IsEmpty());
+
+    const auto& cr = r;
+    EXPECT_THAT(clara::data_cast<std::string>(cr), StrEq("event"));
+    EXPECT_THAT(clara::data_cast<std::string>(cr), StrEq("event"));
+
+    EXPECT_THAT(s->reads, Eq(1));
+    EXPECT_THAT(e.is_deserialized(r), Eq(true));
+    EXPECT_THAT(e.has_bytes(r), Eq(true));
+}
+
+
+TEST(EngineData, UntouchedDataReusesReceivedBytes)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto [dt, s] = counting_type();
+    auto t = clara::DataTypeTable{{dt}};
+    auto topic = clara::msg::Topic::raw("topic");
+
+    auto d = clara::EngineData{};
+    d.set_data(dt, std::string{"event"});
+    auto m = e.serialize(d, topic, t);
+    auto r = e.deserialize(m, t);
+
+    const auto& cr = r;
+    EXPECT_THAT(clara::data_cast<std::string>(cr), StrEq("event"));
+
+    auto o = e.serialize(clara::EngineData{r}, topic, t);
+
+    EXPECT_THAT(s->writes, Eq(1));
+    EXPECT_THAT(clara::msg::parse_message<std::string>(o), StrEq("event"));
+}
+
+
+TEST(EngineData, ModifiedDataIsSerializedAgain)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto [dt, s] = counting_type();
+    auto t = clara::DataTypeTable{{dt}};
+    auto topic = clara::msg::Topic::raw("topic");
+
+    auto d = clara::EngineData{};
+    d.set_data(dt, std::string{"event"});
+    auto m = e.serialize(d, topic, t);
+    auto r = e.deserialize(m, t);
+
+    clara::data_cast<std::string>(r) += "-modified";
+
+    EXPECT_THAT(e.has_bytes(r), Eq(false));
+
+    auto o = e.serialize(r, topic, t);
+
+    EXPECT_THAT(s->writes, Eq(2));
+    EXPECT_THAT(clara::msg::parse_message<std::string>(o), StrEq("event-modified"));
+}
+
+
+TEST(EngineData, ReceivedBytesAreRecycled)
+{
+    auto e = clara::EngineDataAccessor{};
+    auto t = clara::DataTypeTable{{clara::type::BYTES}};
+    auto topic = clara::msg::Topic::raw("topic");
+
+    auto d = clara::EngineData{};
+    d.set_data(clara::type::BYTES, std::vector<std::uint8_t>(200 * 1024, 0x1));
+    auto m = e.serialize(d, topic, t);
+
+    const std::uint8_t* bytes = nullptr;
+    {
+        auto r = e.deserialize(m, t);
+        bytes = clara::data_cast<std::vector<std::uint8_t>>(r).data();
+    }
+
+    auto buffer = clara::msg::BufferPool::acquire(200 * 1024);
+
+    EXPECT_THAT(buffer.data(), Eq(bytes));
+}
+
+
 int main(int argc, char* argv[])
 {
     testing::InitGoogleTest(&argc, argv);
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <clara/bytes_view.hpp>
 #include <clara/engine_data_type.hpp>
 
 #include <clara/msg/proto/data.hpp>
@@ -15,6 +16,7 @@
 #include <functional>
 #include <random>
 #include <string>
+#include <utility>
 #include <vector>
 
 using namespace testing;
@@ -96,6 +98,111 @@ TEST(RawBytesSerializer, MoveSemantics)
 }
 
 
+TEST(RawBytesSerializer, WritesBytesView)
+{
+    const auto* s = clara::type::BYTES.serializer();
+
+    auto owner = std::make_shared<std::vector<std::uint8_t>>(
+            std::vector<std::uint8_t>{1, 2, 3, 4, 5});
+    auto view = clara::BytesView{owner->data() + 1, 3, owner};
+    auto buffer = std::vector<std::uint8_t>{};
+    s->write_into(std::any{view}, buffer);
+
+    EXPECT_THAT(s->size_hint(std::any{view}), Eq(3));
+    EXPECT_THAT(s->write(std::any{view}), ElementsAre(2, 3, 4));
+    EXPECT_THAT(buffer, ElementsAre(2, 3, 4));
+    EXPECT_THAT(std::any_cast<std::vector<std::uint8_t>>(s->read(buffer)),
+                ElementsAre(2, 3, 4));
+}
+
+
+TEST(RawArraySerializer, FloatingPointArraySerialization)
+{
+    const auto* s = clara::type::ARRAY_DOUBLE.serializer();
+
+    auto r = std::vector<double>{1.5, -2.25, 1e-300, 4e30};
+
+    const auto b = s->write(std::any{r});
+    const auto d = std::any_cast<decltype(r)>(s->read(b));
+
+    ASSERT_THAT(b.size(), Eq(r.size() * sizeof(double)));
+    ASSERT_THAT(d, ContainerEq(r));
+}
+
+
+TEST(RawArraySerializer, LittleEndianLayout)
+{
+    const auto* s = clara::type::ARRAY_INT32.serializer();
+
+    const auto b = s->write(std::any{std::vector<std::int32_t>{0x01020304, -2}});
+
+    ASSERT_THAT(b, ElementsAre(0x04, 0x03, 0x02, 0x01, 0xfe, 0xff, 0xff, 0xff));
+}
+
+
+TEST(RawArraySerializer, RejectInvalidBuffer)
+{
+    const auto* s = clara::type::ARRAY_INT64.serializer();
+
+    auto b = std::vector<std::uint8_t>(12);
+
+    EXPECT_THROW(s->read(b), std::invalid_argument);
+}
+
+
+TEST(Serializer, WriteIntoBuffer)
+{
+    auto values = std::vector<std::pair<const clara::EngineDataType*, std::any>>{
+        {&clara::type::INT32, std::int32_t{-2048}},
+        {&clara::type::DOUBLE, 3.14},
+        {&clara::type::STRING, std::string{"some text"}},
+        {&clara::type::BYTES, std::vector<std::uint8_t>{0x1, 0xa, 0xff}},
+        {&clara::type::ARRAY_FLOAT, std::vector<float>{1.f, 2.f, 3.f}},
+    };
+
+    for (const auto& [dt, value] : values) {
+        const auto* s = dt->serializer();
+        auto buffer = std::vector<std::uint8_t>(64, 0x0);
+        const auto* mem = buffer.data();
+
+        s->write_into(value, buffer);
+
+        EXPECT_THAT(buffer, ContainerEq(s->write(value))) << dt->mime_type();
+        EXPECT_THAT(buffer.data(), Eq(mem)) << dt->mime_type();
+    }
+}
+
+
+TEST(Serializer, SizeHint)
+{
+    const auto* s = clara::type::STRING.serializer();
+    const auto* b = clara::type::BYTES.serializer();
+
+    EXPECT_THAT(s->size_hint(std::any{std::string{"text"}}), Eq(4));
+    EXPECT_THAT(b->size_hint(std::any{std::vector<std::uint8_t>(10)}), Eq(10));
+}
+
+
+TEST(Serializer, PrimitiveSizeHintFitsSerializedValue)
+{
+    auto values = std::vector<std::pair<const clara::EngineDataType*, std::any>>{
+        {&clara::type::INT32, std::int32_t{-1}},
+        {&clara::type::INT32, std::int32_t{INT32_MAX}},
+        {&clara::type::INT64, std::int64_t{INT64_MIN}},
+        {&clara::type::FLOAT, 1.5f},
+        {&clara::type::DOUBLE, -2.25},
+    };
+
+    for (const auto& [dt, value] : values) {
+        const auto* s = dt->serializer();
+        auto hint = s->size_hint(value);
+
+        EXPECT_THAT(hint, Gt(0)) << dt->mime_type();
+        EXPECT_THAT(s->write(value).size(), Le(hint)) << dt->mime_type();
+    }
+}
+
+
 TEST(JSONSerializer, JSONSerialization)
 {
     const auto* s = clara::type::JSON.serializer();
@@ -119,6 +226,18 @@ TEST(EngineDataType, CompareWithStringMimeType)
 }
 
 
+TEST(EngineDataType, SameMimeTypeHasSameId)
+{
+    auto bytes = clara::EngineDataType{"binary/bytes", nullptr};
+    auto other = clara::EngineDataType{"binary/other-bytes", nullptr};
+
+    ASSERT_THAT(bytes.id(), Eq(clara::type::BYTES.id()));
+    ASSERT_THAT(other.id(), Ne(clara::type::BYTES.id()));
+
+    ASSERT_THAT(clara::type::JSON.id(), Ne(clara::type::STRING.id()));
+}
+
+
 int main(int argc, char* argv[])
 {
     testing::InitGoogleTest(&argc, argv);
@@ -0,0 +1,483 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/stdlib/block_io.hpp>
+#include <clara/stdlib/event_file.hpp>
+#include <clara/stdlib/event_file_reader_service.hpp>
+#include <clara/stdlib/event_file_writer_service.hpp>
+#include <clara/stdlib/json_utils.hpp>
+
+#include <engine_data_helper.hpp>
+
+#include <gmock/gmock.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace testing;
+
+using clara::stdlib::BlockBuffer;
+using clara::stdlib::BlockFile;
+using clara::stdlib::BlockIO;
+using clara::stdlib::EventFileError;
+using clara::stdlib::EventFileOrder;
+using clara::stdlib::EventFileReader;
+using clara::stdlib::EventFileWriter;
+
+
+class EventFileTest : public Test
+{
+protected:
+    EventFileTest()
+      : path_{"/tmp/clara_event_file_test_" + std::to_string(::getpid()) + ".cevf"}
+    {
+        // nop
+    }
+
+    ~EventFileTest() override
+    {
+        std::remove(path_.c_str());
+    }
+
+    static auto bytes(const EventFileReader::Event& event) -> std::vector<std::uint8_t>
+    {
+        return {event.data, event.data + event.size};
+    }
+
+    std::string path_;
+};
+
+
+TEST_F(EventFileTest, ReadsWrittenEvents)
+{
+    auto events = std::vector<std::vector<std::uint8_t>>{
+        {1, 2, 3}, {}, std::vector<std::uint8_t>(100000, 0xab), {4},
+    };
+    {
+        auto writer = EventFileWriter{path_, EventFileOrder::Big};
+        for (const auto& event : events) {
+            writer.write(event);
+        }
+        EXPECT_THAT(writer.count(), Eq(4));
+    }
+
+    auto reader = EventFileReader{path_};
+
+    ASSERT_THAT(reader.count(), Eq(4));
+    EXPECT_THAT(reader.order(), Eq(EventFileOrder::Big));
+    EXPECT_THAT(bytes(reader.event(3)), ContainerEq(events[3]));
+    EXPECT_THAT(bytes(reader.event(1)), IsEmpty());
+    EXPECT_THAT(bytes(reader.event(2)), ContainerEq(events[2]));
+    EXPECT_THAT(bytes(reader.event(0)), ContainerEq(events[0]));
+    EXPECT_THROW(reader.event(4), EventFileError);
+}
+
+
+TEST_F(EventFileTest, ReadsEmptyFile)
+{
+    EventFileWriter{path_}.close();
+
+    auto reader = EventFileReader{path_};
+
+    EXPECT_THAT(reader.count(), Eq(0));
+    EXPECT_THAT(reader.order(), Eq(EventFileOrder::Little));
+}
+
+
+TEST_F(EventFileTest, RejectsFileWithoutIndex)
+{
+    {
+        auto file = std::ofstream{path_, std::ios::binary};
+        file << "CEVF and some bytes that are not an index";
+    }
+
+    EXPECT_THROW(EventFileReader{path_}, EventFileError);
+    EXPECT_THROW(EventFileReader{path_ + ".missing"}, EventFileError);
+}
+
+
+TEST_F(EventFileTest, ServicesReadWrittenEvents)
+{
+    using Bytes = std::vector<std::uint8_t>;
+
+    auto open = clara::EngineData{};
+    open.set_data(clara::type::JSON, R"({"action": "open", "file": ")" + path_ + R"("})");
+    {
+        auto writer = clara::stdlib::EventFileWriterService{};
+        writer.configure(open);
+        for (const auto& value : {Bytes{1}, Bytes{2, 2}, Bytes{3, 3, 3}}) {
+            auto event = clara::EngineData{};
+            event.set_data(clara::type::BYTES, value);
+            auto output = writer.execute(event);
+            EXPECT_THAT(output.status(), Ne(clara::EngineStatus::ERROR));
+        }
+    }
+
+    auto reader = clara::stdlib::EventFileReaderService{};
+    reader.configure(open);
+
+    auto request = clara::EngineData{};
+    request.set_data(clara::type::STRING, std::string{"count"});
+    EXPECT_THAT(clara::data_cast<int>(reader.execute(request)), Eq(3));
+
+    request.set_data(clara::type::STRING, std::string{"next"});
+    auto values = std::vector<Bytes>{};
+    for (int i = 0; i < 3; ++i) {
+        values.push_back(clara::data_cast<Bytes>(reader.execute(request)));
+    }
+    EXPECT_THAT(values, ElementsAre(Bytes{1}, Bytes{2, 2}, Bytes{3, 3, 3}));
+}
+
+
+TEST_F(EventFileTest, ServicesSplitEventsIntoManyFiles)
+{
+    using Bytes = std::vector<std::uint8_t>;
+
+    auto open = clara::EngineData{};
+    open.set_data(clara::type::JSON, R"({"action": "open", "file": ")" + path_
+                                     + R"(", "shards": 2, "rotate_events": 3})");
+    auto close = clara::EngineData{};
+    close.set_data(clara::type::JSON, R"({"action": "close", "file": ")" + path_ + R"("})");
+
+    auto writer = clara::stdlib::EventFileWriterService{};
+    writer.configure(open);
+    auto threads = std::vector<std::thread>{};
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&writer, t] {
+            for (int i = 0; i < 5; ++i) {
+                auto event = clara::EngineData{};
+                event.set_data(clara::type::BYTES, Bytes{std::uint8_t(t * 5 + i)});
+                writer.execute(event);
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    writer.configure(close);
+
+    auto manifest_file = std::ifstream{path_ + ".manifest"};
+    auto manifest_text = std::string{std::istreambuf_iterator<char>{manifest_file}, {}};
+    auto manifest = clara::stdlib::parse_json(manifest_text);
+
+    EXPECT_THAT(manifest["events"].int_value(), Eq(20));
+
+    auto dir = path_.substr(0, path_.rfind('/') + 1);
+    auto values = std::vector<int>{};
+    for (const auto& item : manifest["files"].array_items()) {
+        auto file = dir + item["file"].string_value();
+        auto reader = EventFileReader{file};
+        EXPECT_THAT(reader.count(), Eq(item["events"].int_value()));
+        EXPECT_THAT(reader.count(), Le(3));
+        for (auto i = 0U; i < reader.count(); ++i) {
+            values.push_back(reader.event(i).data[0]);
+        }
+    }
+
+    auto reader = clara::stdlib::EventFileReaderService{};
+    auto open_manifest = clara::EngineData{};
+    open_manifest.set_data(clara::type::JSON, R"({"action": "open", "file": ")"
+                                              + path_ + R"(.manifest"})");
+    reader.configure(open_manifest);
+    auto count = clara::EngineData{};
+    count.set_data(clara::type::STRING, std::string{"count"});
+
+    EXPECT_THAT(clara::data_cast<int>(reader.execute(count)), Eq(20));
+
+    reader.reset();
+    for (const auto& item : manifest["files"].array_items()) {
+        std::remove((dir + item["file"].string_value()).c_str());
+    }
+    std::remove((path_ + ".manifest").c_str());
+    std::sort(values.begin(), values.end());
+
+    EXPECT_THAT(manifest["files"].array_items().size(), Ge(7));
+    EXPECT_THAT(values.size(), Eq(20));
+    EXPECT_THAT(values.front(), Eq(0));
+    EXPECT_THAT(values.back(), Eq(19));
+}
+
+
+TEST_F(EventFileTest, ServicesWriteQueuedBatchesIntoShards)
+{
+    using Bytes = std::vector<std::uint8_t>;
+
+    auto open = clara::EngineData{};
+    open.set_data(clara::type::JSON, R"({"action": "open", "file": ")" + path_
+                                     + R"(", "shards": 3, "queue": 64})");
+    auto close = clara::EngineData{};
+    close.set_data(clara::type::JSON, R"({"action": "close", "file": ")" + path_ + R"("})");
+
+    auto writer = clara::stdlib::EventFileWriterService{};
+    writer.configure(open);
+    for (int i = 0; i < 50; ++i) {
+        auto event = clara::EngineData{};
+        event.set_data(clara::type::BYTES, Bytes{std::uint8_t(i)});
+        writer.execute(event);
+    }
+    writer.configure(close);
+
+    auto base = path_.substr(0, path_.rfind('.'));
+    auto values = std::vector<int>{};
+    for (int f = 0; f < 3; ++f) {
+        auto file = base + "_00" + std::to_string(f) + ".cevf";
+        {
+            auto reader = EventFileReader{file};
+            auto previous = -1;
+            for (auto i = 0U; i < reader.count(); ++i) {
+                auto value = int{reader.event(i).data[0]};
+                EXPECT_THAT(value, Gt(previous));
+                previous = value;
+                values.push_back(value);
+            }
+        }
+        std::remove(file.c_str());
+    }
+    std::remove((path_ + ".manifest").c_str());
+    std::sort(values.begin(), values.end());
+
+    EXPECT_THAT(values.size(), Eq(50));
+    EXPECT_THAT(values.front(), Eq(0));
+    EXPECT_THAT(values.back(), Eq(49));
+}
+
+
+TEST_F(EventFileTest, KeepsWritingWhenRotationFails)
+{
+    using Bytes = std::vector<std::uint8_t>;
+
+    auto base = path_.substr(0, path_.rfind('.'));
+    auto blocked = base + "_001.cevf";
+    ASSERT_THAT(::mkdir(blocked.c_str(), 0755), Eq(0));
+
+    auto open = clara::EngineData{};
+    open.set_data(clara::type::JSON, R"({"action": "open", "file": ")" + path_
+                                     + R"(", "rotate_events": 1})");
+    auto close = clara::EngineData{};
+    close.set_data(clara::type::JSON, R"({"action": "close", "file": ")" + path_ + R"("})");
+
+    auto writer = clara::stdlib::EventFileWriterService{};
+    writer.configure(open);
+    auto outputs = std::vector<clara::EngineData>{};
+    for (int i = 0; i < 2; ++i) {
+        auto event = clara::EngineData{};
+        event.set_data(clara::type::BYTES, Bytes{std::uint8_t(i)});
+        outputs.push_back(writer.execute(event));
+    }
+    writer.configure(close);
+
+    EXPECT_THAT(outputs[0].status(), Eq(clara::EngineStatus::ERROR));
+    EXPECT_THAT(outputs[1].status(), Ne(clara::EngineStatus::ERROR));
+
+    auto reader = EventFileReader{base + "_000.cevf"};
+    EXPECT_THAT(reader.count(), Eq(2));
+
+    ::rmdir(blocked.c_str());
+    std::remove((base + "_000.cevf").c_str());
+    std::remove((base + "_002.cevf").c_str());
+    std::remove((path_ + ".manifest").c_str());
+}
+
+
+TEST_F(EventFileTest, ServiceReadsManyFiles)
+{
+    using Bytes = std::vector<std::uint8_t>;
+
+    auto files = std::vector<std::string>{};
+    for (int f = 0; f < 3; ++f) {
+        files.push_back(path_ + "." + std::to_string(f));
+        auto writer = EventFileWriter{files.back()};
+        for (int i = 0; i < f * 2; ++i) {
+            writer.write(Bytes{std::uint8_t(f * 10 + i)});
+        }
+    }
+
+    auto read_all = [](const std::string& config) {
+        auto open = clara::EngineData{};
+        open.set_data(clara::type::JSON, config);
+        auto reader = clara::stdlib::EventFileReaderService{};
+        reader.configure(open);
+
+        auto request = clara::EngineData{};
+        request.set_data(clara::type::STRING, std::string{"next"});
+        auto values = std::vector<int>{};
+        while (true) {
+            auto output = reader.execute(request);
+            if (output.status() == clara::EngineStatus::ERROR) {
+                return values;
+            }
+            values.push_back(clara::data_cast<Bytes>(output).front());
+        }
+    };
+
+    auto list = read_all(R"({"action": "open", "file": "input", "files": [")"
+                         + files[2] + R"(", ")" + files[0] + R"(", ")" + files[1] + R"("]})");
+    auto glob = read_all(R"({"action": "open", "file": ")" + path_ + R"(.*"})");
+
+    for (const auto& file : files) {
+        std::remove(file.c_str());
+    }
+
+    EXPECT_THAT(list, ElementsAre(20, 21, 22, 23, 10, 11));
+    EXPECT_THAT(glob, ElementsAre(10, 11, 20, 21, 22, 23));
+}
+
+
+TEST_F(EventFileTest, ReadsAndWritesBlocks)
+{
+    auto io = BlockIO{4};
+    {
+        auto file = BlockFile{path_, BlockFile::Mode::Write, true};
+        auto buffer = BlockBuffer{2 * BlockBuffer::alignment};
+        buffer.resize(2 * BlockBuffer::alignment);
+        for (auto i = 0U; i < buffer.size(); ++i) {
+            buffer.data()[i] = static_cast<std::uint8_t>(i % 251);
+        }
+        io.write(file, 0, std::move(buffer)).get();
+        file.truncate(5000);
+    }
+
+    auto file = BlockFile{path_, BlockFile::Mode::Read, true};
+    auto first = io.read(file, 10, 20);
+    auto last = io.read(file, 4090, 910);
+    auto past_end = io.read(file, 4990, 20);
+
+    auto bytes = first.get();
+    ASSERT_THAT(bytes.size(), Eq(20));
+    EXPECT_THAT(bytes.data()[0], Eq(10));
+    bytes = last.get();
+    ASSERT_THAT(bytes.size(), Eq(910));
+    EXPECT_THAT(bytes.data()[909], Eq(4999 % 251));
+    EXPECT_THROW(past_end.get(), clara::stdlib::BlockIOError);
+}
+
+
+TEST_F(EventFileTest, WritesEventsInBlocks)
+{
+    auto events = std::vector<std::vector<std::uint8_t>>{};
+    for (int i = 0; i < 7; ++i) {
+        auto size = (i % 2 == 0) ? EventFileWriter::block_size / 3 : std::size_t(i);
+        events.emplace_back(size, static_cast<std::uint8_t>(i));
+    }
+    {
+        auto io = BlockIO{2};
+        auto writer = EventFileWriter{path_, EventFileOrder::Little, io, 2, true};
+        for (const auto& event : events) {
+            writer.write(event);
+        }
+        writer.close();
+    }
+
+    auto reader = EventFileReader{path_};
+
+    ASSERT_THAT(reader.count(), Eq(events.size()));
+    for (auto i = 0U; i < events.size(); ++i) {
+        EXPECT_THAT(bytes(reader.event(i)), ContainerEq(events[i]));
+    }
+}
+
+
+TEST_F(EventFileTest, ServicesUseBlockIO)
+{
+    using Bytes = std::vector<std::uint8_t>;
+
+    auto open = clara::EngineData{};
+    open.set_data(clara::type::JSON, R"({"action": "open", "file": ")" + path_
+                                     + R"(", "io_depth": 4, "direct": true})");
+    {
+        auto writer = clara::stdlib::EventFileWriterService{};
+        writer.configure(open);
+        for (int i = 0; i < 50; ++i) {
+            auto event = clara::EngineData{};
+            event.set_data(clara::type::BYTES, Bytes(std::size_t(i) * 100, std::uint8_t(i)));
+            writer.execute(event);
+        }
+    }
+
+    auto reader = clara::stdlib::EventFileReaderService{};
+    reader.configure(open);
+
+    auto request = clara::EngineData{};
+    request.set_data(clara::type::STRING, std::string{"next"});
+    for (int i = 0; i < 50; ++i) {
+        auto output = reader.execute(request);
+        ASSERT_THAT(output.status(), Ne(clara::EngineStatus::ERROR));
+        EXPECT_THAT(clara::data_cast<Bytes>(output), Eq(Bytes(std::size_t(i) * 100, std::uint8_t(i))));
+    }
+    EXPECT_THAT(reader.execute(request).status(), Eq(clara::EngineStatus::ERROR));
+}
+
+
+TEST_F(EventFileTest, ServiceReadsViewsOfMappedFile)
+{
+    using Bytes = std::vector<std::uint8_t>;
+    {
+        auto writer = EventFileWriter{path_};
+        writer.write(Bytes{1, 2});
+        writer.write(Bytes{3, 4, 5});
+    }
+
+    auto open = clara::EngineData{};
+    open.set_data(clara::type::JSON, R"({"action": "open", "file": ")" + path_
+                                     + R"(", "zero_copy": true})");
+    auto request = clara::EngineData{};
+    request.set_data(clara::type::STRING, std::string{"next"});
+
+    auto outputs = std::vector<clara::EngineData>{};
+    {
+        auto reader = clara::stdlib::EventFileReaderService{};
+        reader.configure(open);
+        outputs.push_back(reader.execute(request));
+        outputs.push_back(reader.execute(request));
+    }
+    std::remove(path_.c_str());
+
+    const auto& view = clara::data_cast<clara::BytesView>(outputs[1]);
+    auto buffer = clara::type::BYTES.serializer()->write(outputs[0].data());
+
+    EXPECT_THAT(view.to_vector(), ElementsAre(3, 4, 5));
+    EXPECT_THAT(buffer, ElementsAre(1, 2));
+
+    auto reader = clara::stdlib::EventFileReaderService{clara::type::STRING};
+    reader.configure(open);
+    request.set_data(clara::type::STRING, std::string{"count"});
+
+    EXPECT_THAT(reader.execute(request).status(), Eq(clara::EngineStatus::ERROR));
+}
+
+
+TEST_F(EventFileTest, ServiceRejectsZeroCopyWithBlockReads)
+{
+    {
+        auto writer = EventFileWriter{path_};
+        writer.write(std::vector<std::uint8_t>{1, 2});
+    }
+
+    auto open = clara::EngineData{};
+    open.set_data(clara::type::JSON, R"({"action": "open", "file": ")" + path_
+                                     + R"(", "zero_copy": true, "io_depth": 4})");
+    auto request = clara::EngineData{};
+    request.set_data(clara::type::STRING, std::string{"count"});
+
+    auto reader = clara::stdlib::EventFileReaderService{};
+    reader.configure(open);
+
+    EXPECT_THAT(reader.execute(request).status(), Eq(clara::EngineStatus::ERROR));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,448 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/stdlib/event_reader_service.hpp>
+
+#include <engine_data_helper.hpp>
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace testing;
+
+
+// Every event is its own index, event 3 cannot be read
+class FakeReader : public clara::stdlib::EventReaderService
+{
+public:
+    ~FakeReader() override
+    {
+        reset();
+    }
+
+    auto name() const -> std::string override { return "FakeReader"; }
+
+    auto author() const -> std::string override { return "Clara"; }
+
+    auto description() const -> std::string override { return "Fake reader"; }
+
+    auto version() const -> std::string override { return "1.0"; }
+
+private:
+    void open_file(const std::string& /*file*/,
+                   const json11::Json& /*opts*/) override
+    {
+        open_ = true;
+    }
+
+    void close_file() override
+    {
+        open_ = false;
+    }
+
+    auto has_file() -> bool override
+    {
+        return open_;
+    }
+
+    auto read_event(int event_number) -> std::any override
+    {
+        if (event_number == 3) {
+            throw EventReaderError{"bad event"};
+        }
+        return event_number;
+    }
+
+    auto read_event_count() -> int override
+    {
+        return 10;
+    }
+
+    auto read_byte_order() -> Endian override
+    {
+        return Endian::Little;
+    }
+
+    auto get_data_type() const -> const clara::EngineDataType& override
+    {
+        return clara::type::INT32;
+    }
+
+private:
+    bool open_ = false;
+};
+
+
+auto make_request(const std::string& value) -> clara::EngineData
+{
+    auto data = clara::EngineData{};
+    data.set_data(clara::type::STRING, value);
+    return data;
+}
+
+
+void open(clara::Engine& reader, const std::string& config)
+{
+    auto data = clara::EngineData{};
+    data.set_data(clara::type::JSON, config);
+    reader.configure(data);
+}
+
+
+// reads until the end of file, returns the events or -1 for errors
+auto read_all(clara::Engine& reader) -> std::vector<int>
+{
+    auto events = std::vector<int>{};
+    auto request = make_request("next");
+    while (true) {
+        auto output = reader.execute(request);
+        if (output.status() != clara::EngineStatus::ERROR) {
+            events.push_back(clara::data_cast<int>(output));
+        } else if (output.description() == "End of file") {
+            return events;
+        } else {
+            events.push_back(-1);
+        }
+    }
+}
+
+
+TEST(EventReaderService, ReadsEvents)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat"})");
+
+    EXPECT_THAT(read_all(reader), ElementsAre(0, 1, 2, -1, 4, 5, 6, 7, 8, 9));
+}
+
+
+TEST(EventReaderService, PrefetchesEvents)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat", "prefetch": 4})");
+
+    EXPECT_THAT(read_all(reader), ElementsAre(0, 1, 2, -1, 4, 5, 6, 7, 8, 9));
+}
+
+
+TEST(EventReaderService, PrefetchesEventsInLimits)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat",
+                     "skip": 4, "max": 3, "prefetch": 2})");
+
+    EXPECT_THAT(read_all(reader), ElementsAre(4, 5, 6));
+}
+
+
+TEST(EventReaderService, ReopensFileWhilePrefetching)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat", "prefetch": 2})");
+    open(reader, R"({"action": "open", "file": "in.dat",
+                     "skip": 8, "prefetch": 2})");
+
+    EXPECT_THAT(read_all(reader), ElementsAre(8, 9));
+}
+
+
+// reads batches until the end of file, returns the events or -1 for errors
+auto read_all_batches(clara::Engine& reader, const std::string& request)
+    -> std::vector<std::vector<long>>
+{
+    auto batches = std::vector<std::vector<long>>{};
+    auto input = make_request(request);
+    while (true) {
+        auto output = reader.execute(input);
+        if (output.status() != clara::EngineStatus::ERROR) {
+            const auto& batch = clara::data_cast<clara::stdlib::EventBatch>(output);
+            EXPECT_THAT(output.communication_id(), Eq(batch.event_ids.front()));
+            for (auto i = 0U; i < batch.events.size(); ++i) {
+                EXPECT_THAT(std::any_cast<int>(batch.events[i]), Eq(batch.event_ids[i]));
+            }
+            batches.push_back(batch.event_ids);
+        } else if (output.description() == "End of file") {
+            return batches;
+        } else {
+            batches.push_back({-1});
+        }
+    }
+}
+
+
+TEST(EventReaderService, ReadsBatches)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat"})");
+
+    EXPECT_THAT(read_all_batches(reader, "next-batch:2"),
+                ElementsAre(ElementsAre(0, 1), ElementsAre(2), ElementsAre(-1),
+                            ElementsAre(4, 5), ElementsAre(6, 7), ElementsAre(8, 9)));
+}
+
+
+TEST(EventReaderService, PrefetchesBatches)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat", "skip": 4, "prefetch": 3})");
+
+    EXPECT_THAT(read_all_batches(reader, "next-batch"),
+                ElementsAre(ElementsAre(4, 5, 6, 7, 8, 9)));
+}
+
+
+TEST(EventReaderService, RejectsWrongBatchSize)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat"})");
+
+    for (const auto* request : {"next-batch:0", "next-batch:x", "next-batch:2000"}) {
+        auto input = make_request(request);
+        auto output = reader.execute(input);
+
+        EXPECT_THAT(output.status(), Eq(clara::EngineStatus::ERROR));
+    }
+}
+
+
+TEST(EventReaderService, CountsProcessedBatches)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat", "skip": 4})");
+
+    auto request = make_request("next-batch:4");
+    auto first = reader.execute(request);
+    auto second = reader.execute(request);
+
+    auto rec = make_request("next-batch-rec:4");
+    rec.set_communication_id(first.communication_id());
+    auto eof = reader.execute(rec);
+
+    EXPECT_THAT(eof.status(), Eq(clara::EngineStatus::ERROR));
+    EXPECT_THAT(clara::data_cast<int>(eof), Eq(-1));
+
+    rec.set_communication_id(second.communication_id());
+    eof = reader.execute(rec);
+
+    EXPECT_THAT(clara::data_cast<int>(eof), Eq(1));
+}
+
+
+TEST(EventReaderService, SerializesBatches)
+{
+    auto batch_type = clara::stdlib::make_event_batch_type(clara::type::INT32);
+    auto batch = clara::stdlib::EventBatch{{4, 5}, {4, 5}};
+
+    auto buffer = batch_type.serializer()->write(batch);
+    auto result = std::any_cast<clara::stdlib::EventBatch>(
+            batch_type.serializer()->read(buffer));
+
+    EXPECT_THAT(batch_type.mime_type(), StrEq(clara::type::INT32.mime_type() + ";batch"));
+    EXPECT_THAT(result.event_ids, ElementsAre(4, 5));
+    ASSERT_THAT(result.events.size(), Eq(2));
+    EXPECT_THAT(std::any_cast<int>(result.events[1]), Eq(5));
+}
+
+
+// Saves the published events, and acknowledges them if requested
+class FakeEmitter : public clara::Emitter,
+                    public std::enable_shared_from_this<FakeEmitter>
+{
+public:
+    explicit FakeEmitter(clara::stdlib::EventReaderService* reader = nullptr)
+      : reader_{reader}
+    {
+        // nop
+    }
+
+    void emit(clara::EngineData& output) override
+    {
+        auto event = -1;
+        if (output.status() != clara::EngineStatus::ERROR) {
+            event = clara::data_cast<int>(output);
+        }
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            events_.push_back(event);
+        }
+        emitted_.notify_all();
+        if (reader_ != nullptr && event >= 0) {
+            // as the service, every request of the composition has the emitter
+            auto rec = make_request("next-rec");
+            rec.set_communication_id(event);
+            reader_->set_emitter(shared_from_this());
+            auto reply = reader_->execute(rec);
+            if (reply.status() == clara::EngineStatus::ERROR) {
+                std::unique_lock<std::mutex> lock{mutex_};
+                eof_ = clara::data_cast<int>(reply);
+            }
+        }
+    }
+
+    auto wait_events(std::size_t count) -> std::vector<int>
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        emitted_.wait_for(lock, std::chrono::seconds{5}, [this, count] {
+            return events_.size() >= count;
+        });
+        return events_;
+    }
+
+    auto eof() -> int
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        return eof_;
+    }
+
+private:
+    clara::stdlib::EventReaderService* reader_;
+    std::vector<int> events_;
+    int eof_ = 0;
+    std::mutex mutex_;
+    std::condition_variable emitted_;
+};
+
+
+TEST(EventReaderService, StreamsEventsInWindow)
+{
+    auto reader = FakeReader{};
+    auto emitter = std::make_shared<FakeEmitter>();
+
+    open(reader, R"({"action": "open", "file": "in.dat", "skip": 4, "stream": 2})");
+    reader.set_emitter(emitter);
+
+    auto request = make_request("next");
+    auto output = reader.execute(request);
+
+    EXPECT_THAT(output.has_data(), IsFalse());
+    EXPECT_THAT(emitter->wait_events(2), ElementsAre(4, 5));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds{20});
+
+    EXPECT_THAT(emitter->wait_events(2), ElementsAre(4, 5));
+
+    auto rec = make_request("next-rec");
+    rec.set_communication_id(4);
+    reader.set_emitter(emitter);
+    output = reader.execute(rec);
+
+    EXPECT_THAT(output.has_data(), IsFalse());
+    EXPECT_THAT(emitter->wait_events(3), ElementsAre(4, 5, 6));
+}
+
+
+TEST(EventReaderService, StreamsAllEventsWhenAcknowledged)
+{
+    auto reader = FakeReader{};
+    auto emitter = std::make_shared<FakeEmitter>(&reader);
+
+    open(reader, R"({"action": "open", "file": "in.dat", "stream": 4})");
+    reader.set_emitter(emitter);
+
+    auto request = make_request("next");
+    reader.execute(request);
+
+    EXPECT_THAT(emitter->wait_events(10), ElementsAre(0, 1, 2, -1, 4, 5, 6, 7, 8, 9));
+
+    for (int i = 0; i < 100 && emitter->eof() == 0; ++i) {
+        std::this_thread::sleep_for(std::chrono::milliseconds{10});
+    }
+    reader.reset();
+
+    EXPECT_THAT(emitter->eof(), Eq(1));
+}
+
+
+TEST(EventReaderService, StreamRequiresEmitter)
+{
+    auto reader = FakeReader{};
+
+    open(reader, R"({"action": "open", "file": "in.dat", "stream": 4})");
+
+    EXPECT_THAT(read_all(reader), ElementsAre(0, 1, 2, -1, 4, 5, 6, 7, 8, 9));
+}
+
+
+TEST(EventReaderService, RequestsWithoutEmitterGetEvents)
+{
+    auto reader = FakeReader{};
+    auto emitter = std::make_shared<FakeEmitter>();
+
+    open(reader, R"({"action": "open", "file": "in.dat", "stream": 1})");
+    reader.set_emitter(emitter);
+
+    auto request = make_request("next");
+    auto output = reader.execute(request);
+
+    EXPECT_THAT(output.has_data(), IsFalse());
+    EXPECT_THAT(emitter->wait_events(1), ElementsAre(0));
+
+    // a sync request does not use the emitter of the previous request
+    output = reader.execute(request);
+
+    EXPECT_THAT(clara::data_cast<int>(output), Eq(1));
+    EXPECT_THAT(emitter->wait_events(1), ElementsAre(0));
+}
+
+
+// The reader fails with an unexpected exception for event 1
+class FaultyReader : public FakeReader
+{
+public:
+    ~FaultyReader() override
+    {
+        reset();
+    }
+
+private:
+    auto read_event(int event_number) -> std::any override
+    {
+        if (event_number == 1) {
+            throw std::logic_error{"unexpected failure"};
+        }
+        return event_number;
+    }
+};
+
+
+TEST(EventReaderService, StreamPublishesUnexpectedErrors)
+{
+    auto reader = FaultyReader{};
+    auto emitter = std::make_shared<FakeEmitter>(&reader);
+
+    open(reader, R"({"action": "open", "file": "in.dat", "stream": 2})");
+    reader.set_emitter(emitter);
+
+    auto request = make_request("next");
+    reader.execute(request);
+
+    EXPECT_THAT(emitter->wait_events(10), ElementsAre(0, -1, 2, 3, 4, 5, 6, 7, 8, 9));
+
+    reader.reset();
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
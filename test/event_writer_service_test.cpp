@@ -0,0 +1,286 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/stdlib/event_writer_service.hpp>
+
+#include <engine_data_helper.hpp>
+
+#include <gmock/gmock.h>
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+
+// Saves the events in memory, event 13 cannot be written
+class FakeWriter : public clara::stdlib::EventWriterService
+{
+public:
+    ~FakeWriter() override
+    {
+        reset();
+    }
+
+    auto name() const -> std::string override { return "FakeWriter"; }
+
+    auto author() const -> std::string override { return "Clara"; }
+
+    auto description() const -> std::string override { return "Fake writer"; }
+
+    auto version() const -> std::string override { return "1.0"; }
+
+public:
+    // blocks the background writes until resumed
+    void pause()
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        paused_ = true;
+    }
+
+    void resume()
+    {
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            paused_ = false;
+        }
+        resumed_.notify_all();
+    }
+
+    std::vector<int> events;
+    std::vector<std::size_t> batches;
+
+private:
+    void open_file(const std::string& /*file*/,
+                   const json11::Json& /*opts*/) override
+    {
+        open_ = true;
+        events.clear();
+        batches.clear();
+    }
+
+    void close_file() override
+    {
+        open_ = false;
+    }
+
+    auto has_file() -> bool override
+    {
+        return open_;
+    }
+
+    void write_event(const std::any& event) override
+    {
+        auto value = std::any_cast<std::vector<std::int32_t>>(event).front();
+        if (value == 13) {
+            throw EventWriterError{"bad event"};
+        }
+        events.push_back(value);
+    }
+
+    void write_events(const std::vector<std::any>& queued) override
+    {
+        {
+            std::unique_lock<std::mutex> lock{mutex_};
+            resumed_.wait(lock, [this] { return !paused_; });
+        }
+        batches.push_back(queued.size());
+        EventWriterService::write_events(queued);
+    }
+
+    auto get_data_type() const -> const clara::EngineDataType& override
+    {
+        return clara::type::ARRAY_INT32;
+    }
+
+private:
+    bool open_ = false;
+    bool paused_ = false;
+    std::mutex mutex_;
+    std::condition_variable resumed_;
+};
+
+
+void configure(clara::Engine& writer, const std::string& config)
+{
+    auto data = clara::EngineData{};
+    data.set_data(clara::type::JSON, config);
+    writer.configure(data);
+}
+
+
+auto write(clara::Engine& writer, int value) -> clara::EngineData
+{
+    auto event = clara::EngineData{};
+    event.set_data(clara::type::ARRAY_INT32, std::vector<std::int32_t>{value});
+    event.set_communication_id(value);
+    return writer.execute(event);
+}
+
+
+auto skip(clara::Engine& writer, int value) -> clara::EngineData
+{
+    auto event = clara::EngineData{};
+    event.set_data(clara::type::ARRAY_INT32, std::vector<std::int32_t>{value});
+    event.set_communication_id(value);
+    event.set_description("skip");
+    return writer.execute(event);
+}
+
+
+TEST(EventWriterService, WritesEvents)
+{
+    auto writer = FakeWriter{};
+
+    configure(writer, R"({"action": "open", "file": "out.dat"})");
+    for (int i = 0; i < 5; ++i) {
+        auto output = write(writer, i);
+        EXPECT_THAT(clara::data_cast<std::string>(output), StrEq("next-rec"));
+    }
+
+    EXPECT_THAT(writer.events, ElementsAre(0, 1, 2, 3, 4));
+}
+
+
+TEST(EventWriterService, DrainsQueueOnClose)
+{
+    auto writer = FakeWriter{};
+
+    configure(writer, R"({"action": "open", "file": "out.dat", "queue": 8})");
+    writer.pause();
+    for (int i = 0; i < 5; ++i) {
+        auto output = write(writer, i);
+        EXPECT_THAT(clara::data_cast<std::string>(output), StrEq("next-rec"));
+    }
+
+    EXPECT_THAT(writer.queued_events(), Ge(4));
+
+    writer.resume();
+    configure(writer, R"({"action": "close", "file": "out.dat"})");
+
+    EXPECT_THAT(writer.events, ElementsAre(0, 1, 2, 3, 4));
+    EXPECT_THAT(writer.batches.size(), Le(2));
+    EXPECT_THAT(writer.queued_events(), Eq(0));
+}
+
+
+TEST(EventWriterService, ReportsQueuedErrorInNextReply)
+{
+    auto writer = FakeWriter{};
+
+    configure(writer, R"({"action": "open", "file": "out.dat", "queue": 1})");
+    write(writer, 13);
+
+    auto failed = false;
+    for (int i = 1; i < 5; ++i) {
+        auto output = write(writer, i);
+        failed = failed || output.status() == clara::EngineStatus::ERROR;
+    }
+    configure(writer, R"({"action": "close", "file": "out.dat"})");
+
+    EXPECT_THAT(failed, IsTrue());
+    EXPECT_THAT(writer.events, ElementsAre(1, 2, 3, 4));
+}
+
+
+TEST(EventWriterService, WritesOrderedEvents)
+{
+    auto writer = FakeWriter{};
+    configure(writer, R"({"action": "open", "file": "out.dat",
+                          "ordered": true, "skip": 2})");
+    for (auto i : {4, 2, 5}) {
+        auto output = write(writer, i);
+        EXPECT_THAT(clara::data_cast<std::string>(output), StrEq("next-rec"));
+    }
+
+    EXPECT_THAT(writer.events, ElementsAre(2));
+
+    for (auto i : {3, 7, 6}) {
+        write(writer, i);
+    }
+
+    auto stats = writer.reorder_stats();
+
+    EXPECT_THAT(writer.events, ElementsAre(2, 3, 4, 5, 6, 7));
+    EXPECT_THAT(stats.stalls, Eq(3));
+    EXPECT_THAT(stats.high_water, Ge(2));
+}
+
+
+TEST(EventWriterService, ReportsStatsOfTheService)
+{
+    auto writer = FakeWriter{};
+    auto other = FakeWriter{};
+
+    configure(writer, R"({"action": "open", "file": "out.dat", "ordered": true})");
+    configure(other, R"({"action": "open", "file": "other.dat", "ordered": true})");
+    for (auto i : {2, 1, 0}) {
+        write(writer, i);
+    }
+
+    auto stats = writer.stats();
+
+    EXPECT_THAT(stats, ElementsAre(Pair("queued_events", 0),
+                                   Pair("reorder_stalls", 2),
+                                   Pair("reorder_high_water", 3)));
+
+    EXPECT_THAT(other.reorder_stats().stalls, Eq(0));
+    EXPECT_THAT(other.reorder_stats().high_water, Eq(0));
+}
+
+
+TEST(EventWriterService, OrdersSkippedEvents)
+{
+    auto writer = FakeWriter{};
+
+    configure(writer, R"({"action": "open", "file": "out.dat", "ordered": true})");
+    write(writer, 2);
+    skip(writer, 1);
+    write(writer, 0);
+
+    EXPECT_THAT(writer.events, ElementsAre(0, 2));
+}
+
+
+TEST(EventWriterService, ReportsFirstErrorOfReleasedEvents)
+{
+    auto writer = FakeWriter{};
+
+    configure(writer, R"({"action": "open", "file": "out.dat",
+                          "ordered": true, "skip": 12})");
+    write(writer, 14);
+    write(writer, 13);
+
+    auto output = write(writer, 12);
+
+    EXPECT_THAT(output.status(), Eq(clara::EngineStatus::ERROR));
+    EXPECT_THAT(output.description(), StartsWith("event 13: "));
+    EXPECT_THAT(writer.events, ElementsAre(12, 14));
+}
+
+
+TEST(EventWriterService, GivesUpMissingEventsWhenReorderBufferIsFull)
+{
+    auto writer = FakeWriter{};
+
+    configure(writer, R"({"action": "open", "file": "out.dat",
+                          "ordered": true, "reorder_size": 2, "queue": 4})");
+    for (auto i : {2, 3, 4, 6, 1, 0}) {
+        write(writer, i);
+    }
+    configure(writer, R"({"action": "close", "file": "out.dat"})");
+
+    EXPECT_THAT(writer.events, ElementsAre(2, 3, 4, 1, 0, 6));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,195 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "message_pool.hpp"
+
+#include "concurrent_utils.hpp"
+#include "engine_data_helper.hpp"
+
+#include <gmock/gmock.h>
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace cm = clara::msg;
+namespace util = clara::util;
+
+using namespace testing;
+
+
+static std::atomic<long> n_allocs{0};
+
+void* operator new(std::size_t size)
+{
+    n_allocs.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size)) {  // NOLINT
+        return p;
+    }
+    throw std::bad_alloc{};
+}
+
+// not inlined, otherwise GCC warns about mismatched new/free
+[[gnu::noinline]] void operator delete(void* p) noexcept
+{
+    std::free(p);  // NOLINT
+}
+
+[[gnu::noinline]] void operator delete(void* p, std::size_t /*size*/) noexcept
+{
+    std::free(p);  // NOLINT
+}
+
+
+struct RawEvent
+{
+    std::string topic;
+    std::string meta;
+    std::vector<std::uint8_t> data;
+};
+
+
+auto raw_event(int i, const std::string& datatype = "binary/data-evio") -> RawEvent
+{
+    auto meta = cm::proto::make_meta();
+    meta->set_datatype(datatype);
+    meta->set_communicationid(i);
+    meta->set_composition("10.1.1.1_cpp:master:R+10.1.1.1_cpp:master:P;");
+    meta->set_author("10.1.1.1_cpp:master:R");
+
+    auto data = std::vector<std::uint8_t>(1024 + 16 * (i % 8), std::uint8_t(i));
+
+    return {"10.1.1.1_cpp:master:P", meta->SerializeAsString(), std::move(data)};
+}
+
+
+void receive(const RawEvent& raw, cm::Message& msg)
+{
+    cm::detail::assign_message(msg, raw.topic,
+                               raw.meta.data(), raw.meta.size(),
+                               raw.data.data(), raw.data.size());
+}
+
+
+auto empty_message() -> cm::Message
+{
+    return {cm::Topic::raw(""), cm::proto::make_meta(), std::vector<std::uint8_t>{}};
+}
+
+
+TEST(Message, AssignParsesAllParts)
+{
+    auto raw = raw_event(3);
+    auto msg = empty_message();
+
+    receive(raw, msg);
+
+    EXPECT_THAT(msg.topic().str(), StrEq(raw.topic));
+    EXPECT_THAT(msg.datatype(), StrEq("binary/data-evio"));
+    EXPECT_THAT(msg.meta()->communicationid(), Eq(3));
+    EXPECT_THAT(msg.data(), ContainerEq(raw.data));
+}
+
+
+TEST(Message, AssignToMovedFromMessage)
+{
+    auto raw = raw_event(5);
+    auto msg = empty_message();
+    auto other = std::move(msg);
+
+    receive(raw, msg);  // NOLINT(bugprone-use-after-move)
+
+    EXPECT_THAT(msg.meta()->communicationid(), Eq(5));
+    EXPECT_THAT(msg.data(), ContainerEq(raw.data));
+}
+
+
+TEST(MessagePool, RecyclesSlots)
+{
+    auto pool = util::MessagePool{2};
+
+    auto* m1 = pool.acquire();
+    auto* m2 = pool.acquire();
+    auto* m3 = pool.acquire();
+
+    EXPECT_THAT(pool.size(), Eq(3));
+
+    pool.release(m2);
+    pool.release(m1);
+    pool.release(m3);
+
+    EXPECT_THAT(pool.acquire(), Eq(m3));
+    EXPECT_THAT(pool.acquire(), Eq(m1));
+    EXPECT_THAT(pool.acquire(), Eq(m2));
+    EXPECT_THAT(pool.size(), Eq(3));
+}
+
+
+TEST(MessagePool, DispatchDoesNotAllocateInSteadyState)
+{
+    constexpr int n_events = 64;
+    constexpr int n_workers = 4;
+
+    auto events = std::vector<RawEvent>{};
+    for (int i = 0; i < n_events; ++i) {
+        events.push_back(raw_event(i, clara::type::BYTES.mime_type()));
+    }
+
+    auto opts = tp::ThreadPoolOptions{};
+    opts.setThreadCount(n_workers);
+    opts.setQueueSize(n_events);
+    auto thread_pool = util::ThreadPool{opts};
+
+    auto pool = util::MessagePool{n_workers};
+    auto received = empty_message();
+    auto types = clara::DataTypeTable{{clara::type::BYTES}};
+    auto processed = std::atomic<int>{0};
+
+    // same steps as the subscription thread, the service workers
+    // and an engine that reads the received bytes
+    auto execute = [&](cm::Message& msg) {
+        auto size = std::size_t{0};
+        {
+            auto accessor = clara::EngineDataAccessor{};
+            auto input = accessor.deserialize(msg, types);
+            size = std::any_cast<std::vector<std::uint8_t>&>(input.data()).size();
+        }
+        // the input is gone, and its buffer is back in the pool
+        if (size > 0) {
+            processed.fetch_add(1);
+        }
+    };
+    auto dispatch = [&](int first, int last) {
+        for (int i = first; i < last; i += n_workers) {
+            for (int j = i; j < i + n_workers; ++j) {
+                receive(events[j], received);
+                ASSERT_THAT(pool.post(thread_pool, received, execute), Eq(true));
+            }
+            while (processed.load() < i + n_workers) {
+                std::this_thread::yield();
+            }
+        }
+    };
+
+    dispatch(0, n_events / 2);  // warm-up, the pools grow to their final size
+
+    auto before = n_allocs.load();
+    dispatch(n_events / 2, n_events);
+    auto after = n_allocs.load();
+
+    EXPECT_THAT(after - before, Eq(0));
+    EXPECT_THAT(processed.load(), Eq(n_events));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
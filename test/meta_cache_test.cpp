@@ -0,0 +1,69 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "meta_cache.hpp"
+
+#include <clara/engine_data.hpp>
+#include <engine_data_helper.hpp>
+
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+using clara::util::MetaCache;
+
+
+TEST(MetaCache, ReusesReleasedObjects)
+{
+    auto meta = MetaCache::acquire();
+    meta->set_datatype("binary/data-evio");
+    meta->set_composition("10.1.1.1_cpp:master:R+10.1.1.1_cpp:master:P;");
+    const auto* ptr = meta.get();
+
+    MetaCache::release(std::move(meta));
+    auto reused = MetaCache::acquire();
+
+    EXPECT_THAT(meta, IsNull());
+    EXPECT_THAT(reused.get(), Eq(ptr));
+    EXPECT_FALSE(reused->has_datatype());
+    EXPECT_FALSE(reused->has_composition());
+}
+
+
+TEST(MetaCache, AcquiresCopy)
+{
+    auto meta = clara::msg::proto::make_meta();
+    meta->set_datatype("binary/data-evio");
+    meta->set_communicationid(42);
+
+    auto copy = MetaCache::acquire(*meta);
+
+    EXPECT_THAT(*copy, Eq(*meta));
+}
+
+
+TEST(MetaCache, EngineDataReusesMetadata)
+{
+    auto accessor = clara::EngineDataAccessor{};
+    const clara::msg::proto::Meta* ptr = nullptr;
+    {
+        auto data = clara::EngineData{};
+        data.set_data(clara::type::STRING, "event");
+        ptr = accessor.view_meta(data);
+    }
+
+    auto data = clara::EngineData{};
+
+    EXPECT_THAT(accessor.view_meta(data), Eq(ptr));
+    EXPECT_THAT(data.mime_type(), IsEmpty());
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
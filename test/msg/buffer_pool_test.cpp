@@ -0,0 +1,135 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/msg/buffer_pool.hpp>
+#include <clara/msg/message.hpp>
+
+#include <gmock/gmock.h>
+
+#include <thread>
+
+using namespace testing;
+
+namespace cm = clara::msg;
+
+using cm::BufferPool;
+
+constexpr std::size_t KB = 1024;
+constexpr std::size_t MB = 1024 * KB;
+
+
+auto empty_message() -> cm::Message
+{
+    return {cm::Topic::raw(""), cm::proto::make_meta(), std::vector<std::uint8_t>{}};
+}
+
+
+TEST(BufferPool, SmallBuffersUseSmallestClass)
+{
+    auto buffer = BufferPool::acquire(100);
+    buffer.resize(100);
+    const auto* data = buffer.data();
+
+    EXPECT_THAT(buffer.capacity(), Ge(BufferPool::min_size));
+
+    BufferPool::release(std::move(buffer));
+    auto reused = BufferPool::acquire(200);
+
+    EXPECT_THAT(reused.data(), Eq(data));
+}
+
+
+TEST(BufferPool, UnpooledBuffersAreNotKept)
+{
+    auto before = BufferPool::stats();
+
+    auto empty = BufferPool::acquire(0);
+    auto small = std::vector<std::uint8_t>(100);
+    BufferPool::release(std::move(empty));
+    BufferPool::release(std::move(small));
+
+    auto after = BufferPool::stats();
+
+    EXPECT_THAT(after.hits, Eq(before.hits));
+    EXPECT_THAT(after.misses, Eq(before.misses));
+    EXPECT_THAT(after.resident_bytes, Eq(before.resident_bytes));
+}
+
+
+TEST(BufferPool, ReusesReleasedBuffer)
+{
+    auto buffer = BufferPool::acquire(100 * KB);
+    buffer.resize(100 * KB, 0xff);
+    const auto* data = buffer.data();
+
+    EXPECT_THAT(buffer.capacity(), Ge(128 * KB));
+
+    BufferPool::release(std::move(buffer));
+    auto before = BufferPool::stats();
+    auto reused = BufferPool::acquire(70 * KB);
+    auto after = BufferPool::stats();
+
+    EXPECT_THAT(buffer, IsEmpty());
+    EXPECT_THAT(reused, IsEmpty());
+    EXPECT_THAT(reused.data(), Eq(data));
+    EXPECT_THAT(after.hits, Eq(before.hits + 1));
+    EXPECT_THAT(after.resident_bytes, Eq(before.resident_bytes - reused.capacity()));
+}
+
+
+TEST(BufferPool, RoundsUpToSizeClass)
+{
+    auto buffer = BufferPool::acquire(1 * MB + 1);
+
+    EXPECT_THAT(buffer.capacity(), Ge(2 * MB));
+}
+
+
+TEST(BufferPool, SharesBuffersBetweenThreads)
+{
+    auto buffer = BufferPool::acquire(5 * MB);
+    const auto* data = buffer.data();
+
+    auto t = std::thread{[&]() { BufferPool::release(std::move(buffer)); }};
+    t.join();
+
+    auto reused = BufferPool::acquire(6 * MB);
+
+    EXPECT_THAT(reused.data(), Eq(data));
+}
+
+
+TEST(BufferPool, ReceivedMessageReusesData)
+{
+    auto payload = std::vector<std::uint8_t>(300 * KB, 0x1);
+    auto meta = cm::proto::make_meta();
+    meta->set_datatype("binary/data-evio");
+    auto serialized_meta = meta->SerializeAsString();
+
+    const std::uint8_t* data = nullptr;
+    {
+        auto msg = empty_message();
+        cm::detail::assign_message(msg, "data:evio",
+                                   serialized_meta.data(), serialized_meta.size(),
+                                   payload.data(), payload.size());
+        data = msg.data().data();
+    }
+
+    auto msg = empty_message();
+    cm::detail::assign_message(msg, "data:evio",
+                               serialized_meta.data(), serialized_meta.size(),
+                               payload.data(), payload.size());
+
+    EXPECT_THAT(msg.data().data(), Eq(data));
+    EXPECT_THAT(msg.data(), ContainerEq(payload));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/msg/message.hpp>
+#include <clara/msg/proto/meta.hpp>
+
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+namespace cm = clara::msg;
+namespace cd = clara::msg::proto::detail;
+
+using Meta = clara::msg::proto::Meta;
+
+
+auto full_meta() -> std::unique_ptr<Meta>
+{
+    auto meta = cm::proto::make_meta();
+    meta->set_datatype("binary/data-evio");
+    meta->set_version("2.0");
+    meta->set_description("some description");
+    meta->set_author("10.1.1.1_cpp:master:R");
+    meta->set_status(Meta::WARNING);
+    meta->set_severityid(3);
+    meta->set_sender("10.1.1.1_cpp:master:R");
+    meta->set_senderstate("running");
+    meta->set_communicationid(4000000000U);
+    meta->set_composition("10.1.1.1_cpp:master:R+10.1.1.1_cpp:master:P;");
+    meta->set_executiontime(-25);
+    meta->set_action(Meta::CONFIGURE);
+    meta->set_control(Meta::SKIP);
+    meta->set_dattypedescription("evio events");
+    meta->set_replyto("ret:10.1.1.1_java:orchestrator:12");
+    meta->set_byteorder(Meta::Big);
+    return meta;
+}
+
+
+auto read(const std::string& buffer) -> std::unique_ptr<Meta>
+{
+    auto meta = cm::proto::make_meta();
+    cd::read_compact_meta(buffer.data(), buffer.size(), *meta);
+    return meta;
+}
+
+
+TEST(CompactMeta, RoundTripAllFields)
+{
+    auto meta = full_meta();
+    auto buffer = std::string{};
+
+    cd::write_compact_meta(*meta, buffer);
+
+    EXPECT_THAT(*read(buffer), Eq(*meta));
+}
+
+
+TEST(CompactMeta, RoundTripMissingFields)
+{
+    auto meta = cm::proto::make_meta();
+    meta->set_datatype("text/string");
+    meta->set_communicationid(0);
+    meta->set_author("");
+    auto buffer = std::string{};
+
+    cd::write_compact_meta(*meta, buffer);
+    auto result = read(buffer);
+
+    EXPECT_THAT(*result, Eq(*meta));
+    EXPECT_TRUE(result->has_communicationid());
+    EXPECT_TRUE(result->has_author());
+    EXPECT_FALSE(result->has_replyto());
+    EXPECT_FALSE(result->has_status());
+}
+
+
+TEST(CompactMeta, ReadClearsPreviousValues)
+{
+    auto small = cm::proto::make_meta();
+    small->set_datatype("text/string");
+    auto buffer = std::string{};
+    cd::write_compact_meta(*small, buffer);
+
+    auto meta = full_meta();
+    cd::read_compact_meta(buffer.data(), buffer.size(), *meta);
+
+    EXPECT_THAT(*meta, Eq(*small));
+}
+
+
+TEST(CompactMeta, DetectFormat)
+{
+    auto meta = full_meta();
+    auto compact = std::string{};
+    cd::write_compact_meta(*meta, compact);
+    auto protobuf = meta->SerializeAsString();
+
+    EXPECT_TRUE(cd::is_compact_meta(compact.data(), compact.size()));
+    EXPECT_FALSE(cd::is_compact_meta(protobuf.data(), protobuf.size()));
+
+    auto m1 = cm::proto::make_meta();
+    auto m2 = cm::proto::make_meta();
+    cd::parse_meta(compact.data(), compact.size(), *m1);
+    cd::parse_meta(protobuf.data(), protobuf.size(), *m2);
+
+    EXPECT_THAT(*m1, Eq(*meta));
+    EXPECT_THAT(*m2, Eq(*meta));
+}
+
+
+TEST(CompactMeta, TruncatedDataThrows)
+{
+    auto buffer = std::string{};
+    cd::write_compact_meta(*full_meta(), buffer);
+    buffer.resize(buffer.size() - 1);
+
+    EXPECT_THROW(read(buffer), std::invalid_argument);
+    EXPECT_THROW(read(buffer.substr(0, 10)), std::invalid_argument);
+}
+
+
+TEST(CompactMeta, InvalidEnumThrows)
+{
+    auto buffer = std::string{};
+    cd::write_compact_meta(*full_meta(), buffer);
+    buffer[4] = 9;
+
+    EXPECT_THROW(read(buffer), std::invalid_argument);
+}
+
+
+TEST(CompactMeta, ReceiveMessageWithCompactMeta)
+{
+    auto meta = full_meta();
+    auto buffer = std::string{};
+    cd::write_compact_meta(*meta, buffer);
+    auto data = std::vector<std::uint8_t>{0x1, 0x2, 0x3};
+
+    auto msg = cm::Message{cm::Topic::raw(""), cm::proto::make_meta(),
+                           std::vector<std::uint8_t>{}};
+    cm::detail::assign_message(msg, "data:evio",
+                               buffer.data(), buffer.size(),
+                               data.data(), data.size());
+
+    EXPECT_THAT(*msg.meta(), Eq(*meta));
+    EXPECT_THAT(msg.data(), ContainerEq(data));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
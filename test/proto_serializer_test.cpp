@@ -0,0 +1,109 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/proto_serializer.hpp>
+
+#include <clara/engine_data.hpp>
+#include <clara/msg/proto/meta.hpp>
+
+#include <gmock/gmock.h>
+
+using namespace testing;
+
+using Meta = clara::msg::proto::Meta;
+
+
+static const auto META_TYPE = clara::make_proto_type<Meta>("binary/test-meta");
+
+
+auto make_message() -> std::shared_ptr<Meta>
+{
+    auto message = std::make_shared<Meta>();
+    message->set_datatype("binary/data-evio");
+    message->set_author("10.1.1.1_cpp:master:R");
+    message->set_composition("10.1.1.1_cpp:master:R+10.1.1.1_cpp:master:P;");
+    message->set_communicationid(1200);
+    return message;
+}
+
+
+TEST(ProtoSerializer, RoundTrip)
+{
+    const auto* s = META_TYPE.serializer();
+
+    auto bytes = s->write(std::any{make_message()});
+    auto data = s->read(bytes);
+    const auto& message = std::any_cast<const std::shared_ptr<Meta>&>(data);
+
+    EXPECT_THAT(message->author(), StrEq("10.1.1.1_cpp:master:R"));
+    EXPECT_THAT(message->communicationid(), Eq(1200));
+}
+
+
+TEST(ProtoSerializer, WritesExactSize)
+{
+    const auto* s = META_TYPE.serializer();
+    auto message = make_message();
+
+    auto buffer = clara::Serializer::Buffer(1024, 0xff);
+    s->write_into(std::any{message}, buffer);
+
+    EXPECT_THAT(buffer.size(), Eq(message->ByteSizeLong()));
+    EXPECT_THAT(buffer, ContainerEq(s->write(std::any{message})));
+}
+
+
+TEST(ProtoSerializer, ParsesIntoArena)
+{
+    const auto* s = META_TYPE.serializer();
+
+    auto bytes = s->write(std::any{make_message()});
+    auto data = s->read(bytes);
+    const auto& message = std::any_cast<const std::shared_ptr<Meta>&>(data);
+
+    EXPECT_THAT(message->GetArena(), NotNull());
+}
+
+
+TEST(ProtoSerializer, ArenaIsAliveWhileDataIsUsed)
+{
+    const auto* s = META_TYPE.serializer();
+    auto bytes = s->write(std::any{make_message()});
+
+    auto input = clara::EngineData{};
+    input.set_data(META_TYPE, std::any_cast<std::shared_ptr<Meta>>(s->read(bytes)));
+    auto copy = input;
+    input = clara::EngineData{};
+
+    const auto& message = clara::data_cast<std::shared_ptr<Meta>>(copy);
+
+    EXPECT_THAT(message->composition(),
+                StrEq("10.1.1.1_cpp:master:R+10.1.1.1_cpp:master:P;"));
+}
+
+
+TEST(ProtoSerializer, InvalidBytesThrows)
+{
+    const auto* s = META_TYPE.serializer();
+    auto bytes = std::vector<std::uint8_t>{0xff, 0xff, 0xff};
+
+    EXPECT_THROW(s->read(bytes), std::invalid_argument);
+}
+
+
+TEST(ProtoSerializer, NullMessageThrows)
+{
+    const auto* s = META_TYPE.serializer();
+
+    EXPECT_THROW(s->write(std::any{std::shared_ptr<Meta>{}}), std::invalid_argument);
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,239 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/record_batch.hpp>
+#include <clara/engine_data_type.hpp>
+
+#include <gmock/gmock.h>
+
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+using namespace testing;
+
+
+auto hits_batch() -> clara::RecordBatch
+{
+    auto batch = clara::RecordBatch{4};
+    batch.add_column("sector", std::vector<std::int8_t>{1, 2, 3, 4});
+    batch.add_column("adc", std::vector<std::int32_t>{100, 200, 300, 400});
+    batch.add_column("energy", std::vector<double>{0.5, 1.5, 2.5, 3.5});
+    return batch;
+}
+
+
+TEST(RecordBatch, AddColumns)
+{
+    auto batch = hits_batch();
+
+    EXPECT_THAT(batch.rows(), Eq(4));
+    EXPECT_THAT(batch.columns(), SizeIs(3));
+    EXPECT_THAT(batch.has_column("adc"), Eq(true));
+    EXPECT_THAT(batch.has_column("tdc"), Eq(false));
+
+    EXPECT_THAT(batch.column<std::int32_t>("adc"), ElementsAre(100, 200, 300, 400));
+    EXPECT_THAT(batch.column<double>("energy"), ElementsAre(0.5, 1.5, 2.5, 3.5));
+}
+
+
+TEST(RecordBatch, ColumnsAreAligned)
+{
+    auto batch = hits_batch();
+
+    for (const auto& col : batch.columns()) {
+        EXPECT_THAT(col.offset % clara::RecordBatch::alignment, Eq(0)) << col.name;
+    }
+
+    auto sector = reinterpret_cast<std::uintptr_t>(batch.column<std::int8_t>("sector").data());
+    auto energy = reinterpret_cast<std::uintptr_t>(batch.column<double>("energy").data());
+    EXPECT_THAT(sector % clara::RecordBatch::alignment, Eq(0));
+    EXPECT_THAT(energy % clara::RecordBatch::alignment, Eq(0));
+}
+
+
+TEST(RecordBatch, RejectInvalidColumns)
+{
+    auto batch = hits_batch();
+
+    EXPECT_THROW(batch.add_column("adc", std::vector<std::int32_t>(4)), std::invalid_argument);
+    EXPECT_THROW(batch.add_column("tdc", std::vector<std::int32_t>(3)), std::invalid_argument);
+
+    EXPECT_THROW(batch.column<float>("energy"), std::invalid_argument);
+    EXPECT_THROW(batch.column<double>("time"), std::invalid_argument);
+}
+
+
+TEST(RecordBatch, WriteAndRead)
+{
+    auto buffer = clara::RecordBatch::Buffer{};
+    hits_batch().write(buffer);
+
+    EXPECT_THAT(buffer.size(), Eq(hits_batch().serialized_size()));
+
+    auto batch = clara::RecordBatch::read(std::move(buffer));
+
+    EXPECT_THAT(batch.rows(), Eq(4));
+    EXPECT_THAT(batch.column<std::int8_t>("sector"), ElementsAre(1, 2, 3, 4));
+    EXPECT_THAT(batch.column<std::int32_t>("adc"), ElementsAre(100, 200, 300, 400));
+    EXPECT_THAT(batch.column<double>("energy"), ElementsAre(0.5, 1.5, 2.5, 3.5));
+
+    // the received columns are aligned too
+    auto adc = reinterpret_cast<std::uintptr_t>(batch.column<std::int32_t>("adc").data());
+    auto energy = reinterpret_cast<std::uintptr_t>(batch.column<double>("energy").data());
+    EXPECT_THAT(adc % clara::RecordBatch::alignment, Eq(0));
+    EXPECT_THAT(energy % clara::RecordBatch::alignment, Eq(0));
+}
+
+
+auto in_buffer(const void* data, const std::uint8_t* begin, std::size_t size) -> bool
+{
+    const auto* ptr = static_cast<const std::uint8_t*>(data);
+    return ptr >= begin && ptr < begin + size;
+}
+
+
+auto is_aligned(const void* data) -> bool
+{
+    return reinterpret_cast<std::uintptr_t>(data) % clara::RecordBatch::alignment == 0;
+}
+
+
+TEST(RecordBatch, ReadViewsReceivedBuffer)
+{
+    auto buffer = clara::RecordBatch::Buffer{};
+    buffer.reserve(hits_batch().serialized_size() + clara::RecordBatch::alignment);
+    hits_batch().write(buffer);
+    const auto* begin = buffer.data();
+    auto capacity = buffer.capacity();
+
+    auto batch = clara::RecordBatch::read(std::move(buffer));
+    auto copy = batch;
+
+    const auto* adc = batch.column<std::int32_t>("adc").data();
+    EXPECT_THAT(in_buffer(adc, begin, capacity), IsTrue());
+    EXPECT_THAT(is_aligned(adc), IsTrue());
+    EXPECT_THAT(copy.column<std::int32_t>("adc").data(), Eq(adc));
+    EXPECT_THAT(batch.column<std::int32_t>("adc"), ElementsAre(100, 200, 300, 400));
+    EXPECT_THAT(batch.column<double>("energy"), ElementsAre(0.5, 1.5, 2.5, 3.5));
+}
+
+
+TEST(RecordBatch, ReadCopiesSharedBuffer)
+{
+    auto buffer = clara::RecordBatch::Buffer{};
+    hits_batch().write(buffer);
+
+    auto batch = clara::RecordBatch::read(std::as_const(buffer));
+
+    const auto* adc = batch.column<std::int32_t>("adc").data();
+    EXPECT_THAT(in_buffer(adc, buffer.data(), buffer.size()), IsFalse());
+    EXPECT_THAT(is_aligned(adc), IsTrue());
+    EXPECT_THAT(batch.column<std::int32_t>("adc"), ElementsAre(100, 200, 300, 400));
+}
+
+
+TEST(RecordBatch, ReadAlignsBufferWithoutRoom)
+{
+    auto buffer = clara::RecordBatch::Buffer{};
+    hits_batch().write(buffer);
+    buffer.shrink_to_fit();
+
+    auto batch = clara::RecordBatch::read(std::move(buffer));
+
+    EXPECT_THAT(is_aligned(batch.column<std::int32_t>("adc").data()), IsTrue());
+    EXPECT_THAT(batch.column<double>("energy"), ElementsAre(0.5, 1.5, 2.5, 3.5));
+}
+
+
+TEST(RecordBatch, AddColumnToReceivedBatch)
+{
+    auto buffer = clara::RecordBatch::Buffer{};
+    hits_batch().write(buffer);
+
+    auto batch = clara::RecordBatch::read(std::move(buffer));
+    batch.add_column("time", std::vector<float>{1.f, 2.f, 3.f, 4.f});
+
+    auto copy = clara::RecordBatch::Buffer{};
+    batch.write(copy);
+    auto other = clara::RecordBatch::read(std::move(copy));
+
+    EXPECT_THAT(other.column<std::int32_t>("adc"), ElementsAre(100, 200, 300, 400));
+    EXPECT_THAT(other.column<float>("time"), ElementsAre(1.f, 2.f, 3.f, 4.f));
+}
+
+
+TEST(RecordBatch, RejectInvalidBuffer)
+{
+    auto buffer = clara::RecordBatch::Buffer{};
+    hits_batch().write(buffer);
+
+    auto bad_magic = buffer;
+    bad_magic[0] = 'X';
+    EXPECT_THROW(clara::RecordBatch::read(std::move(bad_magic)), std::invalid_argument);
+
+    auto truncated = buffer;
+    truncated.resize(buffer.size() - 8);
+    EXPECT_THROW(clara::RecordBatch::read(std::move(truncated)), std::invalid_argument);
+
+    auto header = buffer;
+    header.resize(20);
+    EXPECT_THROW(clara::RecordBatch::read(std::move(header)), std::invalid_argument);
+}
+
+
+auto hostile_batch(std::uint64_t rows, std::uint64_t offset, std::uint64_t size)
+    -> clara::RecordBatch::Buffer
+{
+    auto buffer = clara::RecordBatch::Buffer{'C', 'R', 'B', '1'};
+    auto put = [&buffer](auto value) {
+        const auto* bytes = reinterpret_cast<const std::uint8_t*>(&value);
+        buffer.insert(buffer.end(), bytes, bytes + sizeof(value));
+    };
+    put(std::uint32_t{1});
+    put(rows);
+    put(static_cast<std::uint8_t>(clara::ColumnType::INT64));
+    put(std::uint32_t{1});
+    buffer.push_back('x');
+    put(offset);
+    put(size);
+    buffer.resize(2 * clara::RecordBatch::alignment, 0);
+    return buffer;
+}
+
+
+TEST(RecordBatch, RejectHostileHeader)
+{
+    // the size of the column overflows to zero
+    auto rows = std::uint64_t{1} << 61;
+    EXPECT_THROW(clara::RecordBatch::read(hostile_batch(rows, 0, 0)), std::invalid_argument);
+
+    // the end of the column overflows
+    auto offset = std::numeric_limits<std::uint64_t>::max() - 63;
+    EXPECT_THROW(clara::RecordBatch::read(hostile_batch(1, offset, 8)), std::invalid_argument);
+    EXPECT_THROW(clara::RecordBatch::read(hostile_batch(1, 64, 8)), std::invalid_argument);
+
+    EXPECT_NO_THROW(clara::RecordBatch::read(hostile_batch(1, 0, 8)));
+}
+
+
+TEST(RecordBatch, DataTypeSerialization)
+{
+    const auto* s = clara::type::RECORD_BATCH.serializer();
+
+    auto b = s->write(std::any{hits_batch()});
+    auto d = std::any_cast<clara::RecordBatch>(s->read(std::move(b)));
+
+    EXPECT_THAT(d.column<double>("energy"), ElementsAre(0.5, 1.5, 2.5, 3.5));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,319 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "service_engine.hpp"
+
+#include "component.hpp"
+#include "engine_data_helper.hpp"
+#include "service_config.hpp"
+#include "service_report.hpp"
+
+#include <gmock/gmock.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+using namespace testing;
+
+
+// Counts the requests, and can hold them until it is released
+class CountingEngine : public clara::Engine
+{
+public:
+    auto configure(clara::EngineData& /*input*/) -> clara::EngineData override
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        ++configured_;
+        return {};
+    }
+
+    auto execute(clara::EngineData& input) -> clara::EngineData override
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        ++running_;
+        cv_.notify_all();
+        cv_.wait(lock, [this] { return !hold_; });
+        --running_;
+        ++executed_;
+        return input;
+    }
+
+    auto execute_group(const std::vector<clara::EngineData>& /*inputs*/)
+        -> clara::EngineData override
+    {
+        return {};
+    }
+
+    auto input_data_types() const -> std::vector<clara::EngineDataType> override
+    {
+        return {clara::type::STRING};
+    }
+
+    auto output_data_types() const -> std::vector<clara::EngineDataType> override
+    {
+        return {clara::type::STRING};
+    }
+
+    auto name() const -> std::string override { return "CountingEngine"; }
+
+    auto author() const -> std::string override { return "Clara"; }
+
+    auto description() const -> std::string override { return "Counting engine"; }
+
+    auto version() const -> std::string override { return "1.0"; }
+
+public:
+    void hold(bool value)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        hold_ = value;
+        cv_.notify_all();
+    }
+
+    void wait_running(int n)
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        cv_.wait(lock, [this, n] { return running_ == n; });
+    }
+
+    auto running() -> int
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        return running_;
+    }
+
+    auto executed() -> int
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        return executed_;
+    }
+
+    auto configured() -> int
+    {
+        std::unique_lock<std::mutex> lock{mutex_};
+        return configured_;
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    bool hold_ = false;
+    int running_ = 0;
+    int executed_ = 0;
+    int configured_ = 0;
+};
+
+
+class ServiceEngineTest : public Test
+{
+protected:
+    auto make_service(std::vector<clara::Engine*> engines, int pool_size)
+        -> std::unique_ptr<clara::ServiceEngine>
+    {
+        auto params = clara::ServiceParameters{};
+        params.engine_name = "CountingEngine";
+        params.pool_size = pool_size;
+        params.engine_per_worker = engines.size() > 1;
+
+        report_ = std::make_unique<clara::ServiceReport>(self_.name(), params,
+                                                         "Clara", "1.0", "");
+        return std::make_unique<clara::ServiceEngine>(self_, dpe_, std::move(engines),
+                                                      report_.get(), &config_);
+    }
+
+    // the service is the end of the composition, nothing is published
+    auto make_input() -> clara::EngineData
+    {
+        auto data = clara::EngineData{};
+        data.set_data(clara::type::STRING.mime_type(), "next");
+        accessor_.view_meta(data)->set_composition(self_.name() + ";");
+        return data;
+    }
+
+    auto make_request() -> clara::msg::Message
+    {
+        auto data = make_input();
+        auto types = clara::DataTypeTable{{clara::type::STRING}};
+        return accessor_.serialize(data, self_.topic(), types);
+    }
+
+    auto make_config() -> clara::msg::Message
+    {
+        auto data = clara::EngineData{};
+        data.set_data(clara::type::STRING.mime_type(), "config");
+        auto types = clara::DataTypeTable{{clara::type::STRING}};
+        return accessor_.serialize(data, self_.topic(), types);
+    }
+
+protected:
+    clara::Component dpe_ = clara::Component::dpe(clara::msg::ProxyAddress{"10.1.1.1"});
+    clara::Component self_ = clara::Component::service(
+            clara::Component::container(dpe_, "master"), "S");
+
+    clara::EngineDataAccessor accessor_;
+    clara::ServiceConfig config_;
+    std::unique_ptr<clara::ServiceReport> report_;
+};
+
+
+TEST_F(ServiceEngineTest, FusedRequestsRunInCallerThread)
+{
+    auto engine = CountingEngine{};
+    auto service = make_service({&engine}, 1);
+
+    auto input = make_input();
+
+    EXPECT_THAT(service->try_execute(input), Eq(true));
+    EXPECT_THAT(engine.executed(), Eq(1));
+    EXPECT_THAT(report_->n_requests(), Eq(1));
+}
+
+
+TEST_F(ServiceEngineTest, FusedRequestsAreLimitedByPoolSize)
+{
+    auto engine = CountingEngine{};
+    auto service = make_service({&engine}, 1);
+
+    engine.hold(true);
+    auto first = std::async(std::launch::async, [&] {
+        auto input = make_input();
+        return service->try_execute(input);
+    });
+    engine.wait_running(1);
+
+    // the only worker is busy with the first request, queue the second one
+    auto input = make_input();
+    EXPECT_THAT(service->try_execute(input), Eq(false));
+
+    engine.hold(false);
+    EXPECT_THAT(first.get(), Eq(true));
+
+    EXPECT_THAT(service->try_execute(input), Eq(true));
+    EXPECT_THAT(engine.executed(), Eq(2));
+}
+
+
+TEST_F(ServiceEngineTest, FusedRequestsAreQueuedWhenPoolIsBusy)
+{
+    auto engine = CountingEngine{};
+    auto service = make_service({&engine}, 1);
+
+    engine.hold(true);
+    auto pooled = std::async(std::launch::async, [&] {
+        auto msg = make_request();
+        service->execute(msg);
+    });
+    engine.wait_running(1);
+
+    auto input = make_input();
+    EXPECT_THAT(service->try_execute(input), Eq(false));
+
+    engine.hold(false);
+    pooled.get();
+
+    EXPECT_THAT(engine.executed(), Eq(1));
+}
+
+
+TEST_F(ServiceEngineTest, PoolRequestsWaitForFusedRequests)
+{
+    auto engine = CountingEngine{};
+    auto service = make_service({&engine}, 1);
+
+    engine.hold(true);
+    auto fused = std::async(std::launch::async, [&] {
+        auto input = make_input();
+        return service->try_execute(input);
+    });
+    engine.wait_running(1);
+
+    auto pooled = std::async(std::launch::async, [&] {
+        auto msg = make_request();
+        service->execute(msg);
+    });
+
+    EXPECT_THAT(pooled.wait_for(std::chrono::milliseconds{50}),
+                Eq(std::future_status::timeout));
+    EXPECT_THAT(engine.running(), Eq(1));
+
+    engine.hold(false);
+    EXPECT_THAT(fused.get(), Eq(true));
+    pooled.get();
+
+    EXPECT_THAT(engine.executed(), Eq(2));
+}
+
+
+TEST_F(ServiceEngineTest, FusedRequestsNeedSharedEngine)
+{
+    auto engine1 = CountingEngine{};
+    auto engine2 = CountingEngine{};
+    auto service = make_service({&engine1, &engine2}, 2);
+
+    auto input = make_input();
+
+    EXPECT_THAT(service->try_execute(input), Eq(false));
+    EXPECT_THAT(engine1.executed() + engine2.executed(), Eq(0));
+}
+
+
+TEST_F(ServiceEngineTest, PerWorkerConfigureAllEngines)
+{
+    auto engine1 = CountingEngine{};
+    auto engine2 = CountingEngine{};
+    auto service = make_service({&engine1, &engine2}, 2);
+
+    auto msg = make_config();
+    service->configure(msg);
+
+    EXPECT_THAT(engine1.configured(), Eq(1));
+    EXPECT_THAT(engine2.configured(), Eq(1));
+}
+
+
+TEST_F(ServiceEngineTest, PerWorkerConfigureWaitsForRunningRequests)
+{
+    auto engine1 = CountingEngine{};
+    auto engine2 = CountingEngine{};
+    auto service = make_service({&engine1, &engine2}, 2);
+
+    // threads out of the pool run the first engine
+    engine1.hold(true);
+    auto running = std::async(std::launch::async, [&] {
+        auto input = make_input();
+        service->execute(input);
+    });
+    engine1.wait_running(1);
+
+    auto configured = std::async(std::launch::async, [&] {
+        auto msg = make_config();
+        service->configure(msg);
+    });
+
+    EXPECT_THAT(configured.wait_for(std::chrono::milliseconds{50}),
+                Eq(std::future_status::timeout));
+    EXPECT_THAT(engine1.configured() + engine2.configured(), Eq(0));
+
+    engine1.hold(false);
+    running.get();
+    configured.get();
+
+    EXPECT_THAT(engine1.executed(), Eq(1));
+    EXPECT_THAT(engine1.configured(), Eq(1));
+    EXPECT_THAT(engine2.configured(), Eq(1));
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}
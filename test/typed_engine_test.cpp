@@ -0,0 +1,149 @@
+/*
+ * SPDX-FileCopyrightText: © The Clara Framework Authors
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <clara/typed_engine.hpp>
+
+#include <engine_data_helper.hpp>
+
+#include <gmock/gmock.h>
+
+#include <numeric>
+
+using namespace testing;
+
+
+class SumEngine : public clara::TypedEngine<std::vector<double>, double>
+{
+public:
+    auto execute(const std::vector<double>& input) -> double override
+    {
+        return std::accumulate(input.begin(), input.end(), 0.0);
+    }
+
+    auto configure(clara::EngineData& /*input*/) -> clara::EngineData override
+    {
+        return {};
+    }
+
+    auto name() const -> std::string override { return "SumEngine"; }
+
+    auto author() const -> std::string override { return "Clara"; }
+
+    auto description() const -> std::string override { return "Sums arrays"; }
+
+    auto version() const -> std::string override { return "1.0"; }
+};
+
+
+TEST(TypedEngine, DerivesDataTypes)
+{
+    auto engine = SumEngine{};
+
+    auto in = engine.input_data_types();
+    auto out = engine.output_data_types();
+
+    ASSERT_THAT(in.size(), Eq(1));
+    ASSERT_THAT(out.size(), Eq(1));
+    EXPECT_THAT(in[0].mime_type(), StrEq(clara::type::ARRAY_DOUBLE.mime_type()));
+    EXPECT_THAT(out[0].mime_type(), StrEq(clara::type::DOUBLE.mime_type()));
+}
+
+
+TEST(TypedEngine, ExecutesTypedValue)
+{
+    auto engine = SumEngine{};
+    auto& base = static_cast<clara::Engine&>(engine);
+
+    auto input = clara::EngineData{};
+    input.set_data(clara::type::ARRAY_DOUBLE, std::vector<double>{1.5, 2.5, 3.0});
+
+    auto output = base.execute(input);
+
+    EXPECT_THAT(output.mime_type(), StrEq(clara::type::DOUBLE.mime_type()));
+    EXPECT_THAT(clara::data_cast<double>(output), DoubleEq(7.0));
+}
+
+
+TEST(TypedEngine, ExecutesReceivedData)
+{
+    auto engine = SumEngine{};
+    auto& base = static_cast<clara::Engine&>(engine);
+    auto accessor = clara::EngineDataAccessor{};
+    auto table = clara::DataTypeTable{engine.input_data_types()};
+
+    auto source = clara::EngineData{};
+    source.set_data(clara::type::ARRAY_DOUBLE, std::vector<double>{4.0, 5.0});
+    auto topic = clara::msg::Topic::raw("data");
+    auto msg = accessor.serialize(source, topic, table);
+
+    auto input = accessor.deserialize(msg, table);
+    auto output = base.execute(input);
+
+    EXPECT_THAT(clara::data_cast<double>(output), DoubleEq(9.0));
+}
+
+
+class ChecksumEngine : public clara::TypedEngine<clara::BytesView, std::int32_t>
+{
+public:
+    auto execute(const clara::BytesView& input) -> std::int32_t override
+    {
+        return std::accumulate(input.begin(), input.end(), 0);
+    }
+
+    auto configure(clara::EngineData& /*input*/) -> clara::EngineData override
+    {
+        return {};
+    }
+
+    auto name() const -> std::string override { return "ChecksumEngine"; }
+
+    auto author() const -> std::string override { return "Clara"; }
+
+    auto description() const -> std::string override { return "Adds bytes"; }
+
+    auto version() const -> std::string override { return "1.0"; }
+};
+
+
+TEST(TypedEngine, ConvertsBytesAndViews)
+{
+    using Bytes = std::vector<std::uint8_t>;
+
+    auto checksum = ChecksumEngine{};
+    auto& base = static_cast<clara::Engine&>(checksum);
+
+    auto input = clara::EngineData{};
+    input.set_data(clara::type::BYTES, Bytes{1, 2, 3});
+
+    EXPECT_THAT(checksum.input_data_types()[0].mime_type(),
+                StrEq(clara::type::BYTES.mime_type()));
+    EXPECT_THAT(clara::data_cast<std::int32_t>(base.execute(input)), Eq(6));
+
+    auto owner = std::make_shared<Bytes>(Bytes{4, 5, 6});
+    input.set_data(clara::type::BYTES, clara::BytesView{owner->data(), 2, owner});
+
+    EXPECT_THAT(clara::data_cast<std::int32_t>(base.execute(input)), Eq(9));
+}
+
+
+TEST(TypedEngine, WrongValueTypeThrows)
+{
+    auto engine = SumEngine{};
+    auto& base = static_cast<clara::Engine&>(engine);
+
+    auto input = clara::EngineData{};
+    input.set_data(clara::type::STRING, "next");
+
+    EXPECT_THROW(base.execute(input), std::bad_any_cast);
+}
+
+
+int main(int argc, char* argv[])
+{
+    testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
+}